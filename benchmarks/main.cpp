@@ -0,0 +1,8 @@
+#include "Benchmark.hpp"
+
+
+// Runs the container benchmarks; see Benchmark.hpp for the options, e.g.
+//     benchmark --suites=tree --types=int,string --sizes=100000 --format=json
+int main(int argc, char** argv) {
+    return BenchmarkRunner::run(argc, argv);
+}
@@ -1,5 +1,6 @@
 #pragma once
 #include "Sequence/Sequence.hpp"
+#include "AVLTreeStats.hpp"
 #include <functional>
 #include <iostream>
 #include <string>
@@ -7,6 +8,53 @@
 #include <math.h>
 #include <iomanip>
 #include <sstream>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+
+template <typename T, typename = void>
+struct HasMemberThreeWayCompare : std::false_type {};
+
+template <typename T>
+struct HasMemberThreeWayCompare<T, std::void_t<decltype(std::declval<const T&>().Compare(std::declval<const T&>()))>>
+    : std::is_convertible<decltype(std::declval<const T&>().Compare(std::declval<const T&>())), int> {};
+
+template <typename T, typename = void>
+struct HasStringCompare : std::false_type {};
+
+template <typename T>
+struct HasStringCompare<T, std::void_t<decltype(std::declval<const T&>().compare(std::declval<const T&>()))>>
+    : std::is_convertible<decltype(std::declval<const T&>().compare(std::declval<const T&>())), int> {};
+
+// Three-way ordering used by AVLTree: negative, zero or positive as a orders before,
+// equal to or after b. A type's own Compare() member is the single-pass path and is
+// used first, then a compare() member such as std::string's, and finally two
+// operator< calls for types that only provide that. Specialise for types that need a different order.
+template <typename T>
+struct ThreeWayCompare {
+    int operator()(const T& a, const T& b) const {
+        if constexpr (HasMemberThreeWayCompare<T>::value) {
+            return a.Compare(b);
+        } else if constexpr (HasStringCompare<T>::value) {
+            int order = a.compare(b);
+            return (order > 0) - (order < 0);
+        } else {
+            if (a < b) return -1;
+            return b < a ? 1 : 0;
+        }
+    }
+};
+
+// Index entries are pairs; comparing them member-wise keeps each member on its own
+// three-way path instead of falling back to std::pair's operator<.
+template <typename First, typename Second>
+struct ThreeWayCompare<std::pair<First, Second>> {
+    int operator()(const std::pair<First, Second>& a, const std::pair<First, Second>& b) const {
+        if (int order = ThreeWayCompare<First>()(a.first, b.first)) return order;
+        return ThreeWayCompare<Second>()(a.second, b.second);
+    }
+};
 
 
 template<typename T>
@@ -18,12 +66,25 @@ private:
         Node* right;
         int height, size;
 
-        Node(const T& val) : data(val), left(nullptr), right(nullptr), height(1), size(1) {}
+        Node(const T& val) : data(val), left(nullptr), right(nullptr), height(1), size(1) {
+            AVLTREE_COUNT(allocations);
+        }
+
+#ifdef AVLTREE_STATS
+        ~Node() {
+            AVLTREE_COUNT(frees);
+        }
+#endif
     };
 
     Node* root;
 
 private:
+    static int compare(const T& a, const T& b) {
+        AVLTREE_COUNT(comparisons);
+        return ThreeWayCompare<T>()(a, b);
+    }
+
     int height(Node* node) const {
         return node ? node->height : 0;
     }
@@ -32,6 +93,11 @@ private:
         return node ? node->size : 0;
     }
 
+    static std::size_t ownedHeap(const Node* node) {
+        if (!node) return 0;
+        return OwnedHeap<T>::Bytes(node->data) + ownedHeap(node->left) + ownedHeap(node->right);
+    }
+
     int balanceFactor(Node* node) {
         return node ? height(node->left) - height(node->right) : 0;
     }
@@ -44,6 +110,7 @@ private:
     }
 
     Node* rotateRight(Node* y) {
+        AVLTREE_COUNT(rotationsRight);
         Node* x = y->left;
         Node* T2 = x->right;
 
@@ -57,6 +124,7 @@ private:
     }
 
     Node* rotateLeft(Node* x) {
+        AVLTREE_COUNT(rotationsLeft);
         Node* y = x->right;
         Node* T2 = y->left;
 
@@ -71,6 +139,7 @@ private:
 
     Node* balance(Node* node) {
         if (!node) return node;
+        AVLTREE_COUNT(balances);
 
         int bf = balanceFactor(node);
 
@@ -95,10 +164,12 @@ private:
 
     Node* insert(Node* node, const T& val) {
         if (!node) return new Node(val);
+        AVLTREE_COUNT(pathNodes);
 
-        if (val < node->data)
+        int order = compare(val, node->data);
+        if (order < 0)
             node->left = insert(node->left, val);
-        else if (node->data < val)
+        else if (order > 0)
             node->right = insert(node->right, val);
         else
             return node;
@@ -115,10 +186,12 @@ private:
 
     Node* remove(Node* node, const T& val) {
         if (!node) return node;
+        AVLTREE_COUNT(pathNodes);
 
-        if (val < node->data) {
+        int order = compare(val, node->data);
+        if (order < 0) {
             node->left = remove(node->left, val);
-        } else if (node->data < val) {
+        } else if (order > 0) {
             node->right = remove(node->right, val);
         } else {
             if (!node->left || !node->right) {
@@ -144,17 +217,33 @@ private:
         return balance(node);
     }
 
-    bool contains(Node* node, const T& val) {
+    bool contains(Node* node, const T& val) const {
         if (!node) return false;
+        AVLTREE_COUNT(pathNodes);
 
-        if (val < node->data)
+        int order = compare(val, node->data);
+        if (order < 0)
             return contains(node->left, val);
-        else if (node->data < val)
+        else if (order > 0)
             return contains(node->right, val);
 
         return true;
     }
 
+    template <typename Visitor>
+    void forEachInRange(const Node* node, const T& low, const T& high, Visitor& visit) const {
+        if (!node) return;
+
+        int fromLow = compare(node->data, low);
+        int fromHigh = compare(node->data, high);
+        if (fromLow > 0)
+            forEachInRange(node->left, low, high, visit);
+        if (fromLow >= 0 && fromHigh <= 0)
+            visit(node->data);
+        if (fromHigh < 0)
+            forEachInRange(node->right, low, high, visit);
+    }
+
     void clear(Node* node) {
         if (node) {
             clear(node->left);
@@ -213,29 +302,241 @@ private:
         return left ? left : right;
     }
 
+    Node* join(Node* left, Node* mid, Node* right) {
+        if (height(left) > height(right) + 1) {
+            left->right = join(left->right, mid, right);
+            return balance(left);
+        }
+        if (height(right) > height(left) + 1) {
+            right->left = join(left, mid, right->left);
+            return balance(right);
+        }
+
+        mid->left = left;
+        mid->right = right;
+        updateNode(mid);
+        return mid;
+    }
+
+    Node* detachMin(Node* node, Node*& minNode) {
+        if (!node->left) {
+            minNode = node;
+            Node* right = node->right;
+            node->right = nullptr;
+            updateNode(node);
+            return right;
+        }
+
+        node->left = detachMin(node->left, minNode);
+        return balance(node);
+    }
+
+    Node* join(Node* left, Node* right) {
+        if (!left) return right;
+        if (!right) return left;
+
+        Node* mid = nullptr;
+        right = detachMin(right, mid);
+        return join(left, mid, right);
+    }
+
+    void split(Node* node, const T& key, Node*& left, Node*& found, Node*& right) {
+        if (!node) {
+            left = found = right = nullptr;
+            return;
+        }
+
+        Node* nodeLeft = node->left;
+        Node* nodeRight = node->right;
+
+        int order = compare(key, node->data);
+        if (order < 0) {
+            Node* rest = nullptr;
+            split(nodeLeft, key, left, found, rest);
+            right = join(rest, node, nodeRight);
+        } else if (order > 0) {
+            Node* rest = nullptr;
+            split(nodeRight, key, rest, found, right);
+            left = join(nodeLeft, node, rest);
+        } else {
+            left = nodeLeft;
+            right = nodeRight;
+            node->left = node->right = nullptr;
+            updateNode(node);
+            found = node;
+        }
+    }
+
+    // items[begin, end) must be sorted and free of duplicates.
+    Node* buildBalanced(const T* items, int begin, int end) {
+        if (begin >= end) return nullptr;
+
+        int mid = begin + (end - begin) / 2;
+        Node* node = new Node(items[mid]);
+        node->left = buildBalanced(items, begin, mid);
+        node->right = buildBalanced(items, mid + 1, end);
+        updateNode(node);
+        return node;
+    }
+
+    Node* uniteNodes(Node* node, const Node* other) {
+        if (!other) return node;
+        if (!node) {
+            Node* copy = nullptr;
+            copySubtree(other, copy);
+            return copy;
+        }
+
+        Node *left, *found, *right;
+        split(node, other->data, left, found, right);
+        left = uniteNodes(left, other->left);
+        right = uniteNodes(right, other->right);
+
+        return join(left, found ? found : new Node(other->data), right);
+    }
+
+    Node* intersectNodes(Node* node, const Node* other) {
+        if (!node) return nullptr;
+        if (!other) {
+            clear(node);
+            return nullptr;
+        }
+
+        Node *left, *found, *right;
+        split(node, other->data, left, found, right);
+        left = intersectNodes(left, other->left);
+        right = intersectNodes(right, other->right);
+
+        return found ? join(left, found, right) : join(left, right);
+    }
+
+    Node* subtractNodes(Node* node, const Node* other) {
+        if (!node || !other) return node;
+
+        Node *left, *found, *right;
+        split(node, other->data, left, found, right);
+        delete found;
+        left = subtractNodes(left, other->left);
+        right = subtractNodes(right, other->right);
+
+        return join(left, right);
+    }
+
+    Node* symmetricSubtractNodes(Node* node, const Node* other) {
+        if (!other) return node;
+        if (!node) {
+            Node* copy = nullptr;
+            copySubtree(other, copy);
+            return copy;
+        }
+
+        Node *left, *found, *right;
+        split(node, other->data, left, found, right);
+        left = symmetricSubtractNodes(left, other->left);
+        right = symmetricSubtractNodes(right, other->right);
+
+        if (found) {
+            delete found;
+            return join(left, right);
+        }
+        return join(left, new Node(other->data), right);
+    }
+
 public:
     AVLTree() : root(nullptr) {}
 
+    AVLTree(const AVLTree<T>& other) : root(nullptr) {
+        copySubtree(other.root, root);
+    }
+
+    AVLTree(AVLTree<T>&& other) noexcept : root(other.root) {
+        other.root = nullptr;
+    }
+
     ~AVLTree() {
         clear();
     }
 
-    int size() {
+    AVLTree<T>& operator=(const AVLTree<T>& other) {
+        if (this != &other) {
+            AVLTree<T> copy(other);
+            swap(copy);
+        }
+        return *this;
+    }
+
+    AVLTree<T>& operator=(AVLTree<T>&& other) noexcept {
+        if (this != &other) {
+            clear();
+            root = other.root;
+            other.root = nullptr;
+        }
+        return *this;
+    }
+
+    void swap(AVLTree<T>& other) noexcept {
+        std::swap(root, other.root);
+    }
+
+    int size() const {
         return this->size(root);
     }
 
+    // Child links, heights and sizes count as overhead; node allocations have no slack.
+    MemoryUsage memoryUsage() const {
+        MemoryUsage usage;
+        int count = size();
+        usage.payload = sizeof(T) * count;
+        usage.overhead = sizeof(*this) + (sizeof(Node) - sizeof(T)) * count;
+        if constexpr (OwnedHeap<T>::Tracked) {
+            usage.payload += ownedHeap(root);
+        }
+        return usage;
+    }
+
     void insert(const T& val) {
+        AVLTREE_OPERATION();
         root = insert(root, val);
     }
 
     void remove(const T& val) {
+        AVLTREE_OPERATION();
         root = remove(root, val);
     }
 
-    bool contains(const T& val) {
+    // Sorts and deduplicates a copy of items, builds it into a balanced tree in linear
+    // time and unites it with the current contents.
+    void insertBulk(const T* items, int count) {
+        DynamicArray<T> sorted(items, count);
+        T* first = sorted.GetData();
+
+        std::sort(first, first + count, [](const T& a, const T& b) {
+            return compare(a, b) < 0;
+        });
+        int unique = static_cast<int>(std::unique(first, first + count, [](const T& a, const T& b) {
+            return compare(a, b) == 0;
+        }) - first);
+
+        AVLTree<T> built;
+        built.root = buildBalanced(first, 0, unique);
+        if (!root) {
+            swap(built);
+        } else {
+            unite(built);
+        }
+    }
+
+    bool contains(const T& val) const {
+        AVLTREE_OPERATION();
         return this->contains(root, val);
     }
 
+    // Visits the values in [low, high] in ascending order, skipping subtrees outside the range.
+    template <typename Visitor>
+    void forEachInRange(const T& low, const T& high, Visitor visit) const {
+        forEachInRange(root, low, high, visit);
+    }
+
     void clear() {
         clear(root);
         root = nullptr;
@@ -244,6 +545,12 @@ public:
     bool empty() const {
         return root == nullptr;
     }
+
+    // Throws std::logic_error if the tree is out of order, unbalanced, or has a stale
+    // height or size anywhere. Linear in the size of the tree.
+    void validate() const {
+        validate(root, nullptr, nullptr);
+    }
     
     MutableArraySequence<std::pair<T, int>> traverse(std::string type="LKP") const {
         MutableArraySequence<std::pair<T, int>> result;
@@ -270,18 +577,43 @@ private:
         return 1 + std::max(maxDepth(node->left), maxDepth(node->right));
     }
 
+    // Returns the subtree height after checking order against the (low, high) bounds,
+    // the cached height and size, and the AVL balance condition.
+    int validate(const Node* node, const T* low, const T* high) const {
+        if (!node) return 0;
+
+        if ((low && compare(*low, node->data) >= 0) || (high && compare(node->data, *high) >= 0)) {
+            throw std::logic_error("AVLTree order violated");
+        }
+
+        int leftHeight = validate(node->left, low, &node->data);
+        int rightHeight = validate(node->right, &node->data, high);
+
+        if (leftHeight - rightHeight > 1 || rightHeight - leftHeight > 1) {
+            throw std::logic_error("AVLTree balance violated");
+        }
+        if (node->height != 1 + std::max(leftHeight, rightHeight)) {
+            throw std::logic_error("AVLTree cached height is stale");
+        }
+        if (node->size != 1 + size(node->left) + size(node->right)) {
+            throw std::logic_error("AVLTree cached size is stale");
+        }
+        return node->height;
+    }
+
     Node* findNode(Node* node, const T& val) const {
         if (!node) return nullptr;
 
-        if (val < node->data)
+        int order = compare(val, node->data);
+        if (order < 0)
             return findNode(node->left, val);
-        else if (node->data < val)
+        else if (order > 0)
             return findNode(node->right, val);
         else
             return node;
     }
 
-    void copySubtree(Node* src, Node*& dest) const {
+    void copySubtree(const Node* src, Node*& dest) const {
         if (!src) return;
         
         dest = new Node(src->data);
@@ -398,10 +730,33 @@ public:
     }
 
     void merge(const AVLTree<T>* other) {
-        MutableArraySequence<std::pair<T, int>> elements = other->traverse("LKP");
-        
-        for (auto val : elements)
-            this->insert(val.first);
+        this->unite(*other);
+    }
+
+    void unite(const AVLTree<T>& other) {
+        if (this == &other) return;
+        root = uniteNodes(root, other.root);
+    }
+
+    void intersect(const AVLTree<T>& other) {
+        if (this == &other) return;
+        root = intersectNodes(root, other.root);
+    }
+
+    void subtract(const AVLTree<T>& other) {
+        if (this == &other) {
+            clear();
+            return;
+        }
+        root = subtractNodes(root, other.root);
+    }
+
+    void symmetricSubtract(const AVLTree<T>& other) {
+        if (this == &other) {
+            clear();
+            return;
+        }
+        root = symmetricSubtractNodes(root, other.root);
     }
 
     AVLTree<T>* extractSubtree(const T& val) const {
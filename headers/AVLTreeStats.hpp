@@ -0,0 +1,96 @@
+#pragma once
+
+
+// Work counters for AVLTree, compiled in only when AVLTREE_STATS is defined. Without
+// it the hooks below expand to nothing and AVLTree carries no extra code or state; the
+// struct still exists so reporting code builds either way.
+//
+// Counters are thread-local, so trees used from several threads never contend. Each
+// thread reads its own with Snapshot(); totals across threads are summed with +=.
+//
+// IMPORTANT: AVLTREE_STATS must be defined the same way in every translation unit of a
+// program. AVLTree is header-only, so a unit built with it and one built without it
+// give the same inline functions two different bodies; that is an ODR violation and
+// the linker silently keeps either one. Set it project-wide (the CMake option
+// AVLTREE_STATS adds it to the lab4 target), never with a #define before an include.
+struct AVLTreeStats {
+#ifdef AVLTREE_STATS
+    static constexpr bool Enabled = true;
+#else
+    static constexpr bool Enabled = false;
+#endif
+
+    long long comparisons = 0;
+    long long rotationsLeft = 0;
+    long long rotationsRight = 0;
+    long long balances = 0;
+    long long allocations = 0;
+    long long frees = 0;
+
+    // insert, remove and contains calls, the nodes their searches visited, and the
+    // longest single search path.
+    long long operations = 0;
+    long long pathNodes = 0;
+    long long maxPathNodes = 0;
+
+    double averagePathNodes() const {
+        return operations > 0 ? static_cast<double>(pathNodes) / static_cast<double>(operations) : 0.0;
+    }
+
+    AVLTreeStats& operator+=(const AVLTreeStats& other) {
+        comparisons += other.comparisons;
+        rotationsLeft += other.rotationsLeft;
+        rotationsRight += other.rotationsRight;
+        balances += other.balances;
+        allocations += other.allocations;
+        frees += other.frees;
+        operations += other.operations;
+        pathNodes += other.pathNodes;
+        if (other.maxPathNodes > maxPathNodes) maxPathNodes = other.maxPathNodes;
+        return *this;
+    }
+
+    static AVLTreeStats& Local() {
+        thread_local AVLTreeStats stats;
+        return stats;
+    }
+
+    static AVLTreeStats Snapshot() {
+        return Local();
+    }
+
+    static void Reset() {
+        Local() = AVLTreeStats();
+    }
+};
+
+#ifdef AVLTREE_STATS
+
+// Attributes the nodes visited between construction and destruction to one operation.
+class AVLTreeOperationScope {
+private:
+    long long startPath;
+
+public:
+    AVLTreeOperationScope() : startPath(AVLTreeStats::Local().pathNodes) {}
+
+    ~AVLTreeOperationScope() {
+        AVLTreeStats& stats = AVLTreeStats::Local();
+        long long path = stats.pathNodes - startPath;
+        ++stats.operations;
+        if (path > stats.maxPathNodes) stats.maxPathNodes = path;
+    }
+
+    AVLTreeOperationScope(const AVLTreeOperationScope&) = delete;
+    AVLTreeOperationScope& operator=(const AVLTreeOperationScope&) = delete;
+};
+
+#define AVLTREE_COUNT(field) (++AVLTreeStats::Local().field)
+#define AVLTREE_OPERATION() AVLTreeOperationScope avlTreeOperationScope_
+
+#else
+
+#define AVLTREE_COUNT(field) ((void)0)
+#define AVLTREE_OPERATION() ((void)0)
+
+#endif
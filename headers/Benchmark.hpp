@@ -0,0 +1,541 @@
+#pragma once
+#include "AVLTree.hpp"
+#include "Set.hpp"
+#include "Person.hpp"
+#include "Sequence/Sequence.hpp"
+#include "Sequence/SegmentedSequence.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+
+// Non-interactive timing harness for AVLTree, Set and the Sequence containers.
+//
+//     BenchmarkRunner::run(argc, argv)
+//
+// benchmarks/main.cpp wraps it as the `benchmark` executable in the CMake build.
+//
+// Options (all optional, comma-separated lists):
+//     --suites=tree,set,sequence
+//     --types=int,double,string,student,teacher
+//     --sizes=1000,10000,100000,1000000,10000000
+//     --dist=random,sorted,adversarial
+//     --probes=N     operations timed for InsertAt/Get, which cost O(n) on lists
+//     --seed=N       the same seed always produces the same keys and probe order
+//     --format=csv|json
+//     --out=path     defaults to standard output
+//
+// Every row reports the total wall time and the time per operation, so results from
+// different sizes and runs can be compared directly.
+
+enum class KeyDistribution {
+    Random,
+    Sorted,
+    // Keys alternate between the smallest and largest remaining ones, so every insert
+    // lands on the opposite edge of the tree; sequence probes all hit the middle.
+    Adversarial
+};
+
+inline const char* distributionName(KeyDistribution distribution) {
+    switch (distribution) {
+        case KeyDistribution::Random: return "random";
+        case KeyDistribution::Sorted: return "sorted";
+        default: return "adversarial";
+    }
+}
+
+struct BenchmarkResult {
+    std::string suite;
+    std::string container;
+    std::string type;
+    std::string distribution;
+    std::string operation;
+    int size;
+    long long operations;
+    double seconds;
+
+    double nanosPerOperation() const {
+        return operations > 0 ? seconds * 1e9 / static_cast<double>(operations) : 0.0;
+    }
+};
+
+// Per-type key generation: Make(i) yields distinct keys for distinct i, Map is a cheap
+// transformation and Keep retains roughly half of the keys.
+template <typename T>
+struct BenchmarkKeys;
+
+template <>
+struct BenchmarkKeys<int> {
+    static const char* Name() { return "int"; }
+    static int Make(int i) { return i * 2 + 1; }
+    static int Map(const int& value) { return value + 1; }
+    static bool Keep(const int& value) { return (value / 2) % 2 == 0; }
+};
+
+template <>
+struct BenchmarkKeys<double> {
+    static const char* Name() { return "double"; }
+    static double Make(int i) { return i * 0.5 + 0.25; }
+    static double Map(const double& value) { return value * 1.5; }
+    static bool Keep(const double& value) { return static_cast<long long>(value * 2) % 2 == 0; }
+};
+
+// Zero-padded keys share long prefixes, which is the expensive case for comparisons.
+template <>
+struct BenchmarkKeys<std::string> {
+    static const char* Name() { return "string"; }
+    static std::string Make(int i) {
+        char buffer[24];
+        std::snprintf(buffer, sizeof(buffer), "key-%010d", i);
+        return buffer;
+    }
+    static std::string Map(const std::string& value) { return value + "'"; }
+    static bool Keep(const std::string& value) { return (value.back() - '0') % 2 == 0; }
+};
+
+struct BenchmarkNames {
+    static const std::string& First(int i) {
+        static const std::string names[] = {"Ivan", "Petr", "Anna", "Olga", "Sergey", "Maria", "Dmitry", "Elena"};
+        return names[i % 8];
+    }
+    static const std::string& Middle(int i) {
+        static const std::string names[] = {"Ivanovich", "Petrovich", "Andreevna", "Olegovna", "Sergeevich"};
+        return names[i % 5];
+    }
+    static const std::string& Last(int i) {
+        static const std::string names[] = {"Ivanov", "Petrov", "Sidorova", "Kuznetsova", "Smirnov", "Volkov", "Popova"};
+        return names[i % 7];
+    }
+    static PersonID Id(int i) {
+        // Spread consecutive i over both the series and the number fields.
+        return PersonID::FromPacked(static_cast<std::uint64_t>(i) * 7919 % 10000000000ULL);
+    }
+};
+
+template <>
+struct BenchmarkKeys<Student> {
+    static const char* Name() { return "Student"; }
+    static Student Make(int i) {
+        char studentId[16];
+        std::snprintf(studentId, sizeof(studentId), "S%08d", i);
+        return Student(BenchmarkNames::Id(i), BenchmarkNames::First(i), BenchmarkNames::Middle(i),
+                       BenchmarkNames::Last(i), 0, studentId);
+    }
+    static Student Map(const Student& value) { return value; }
+    static bool Keep(const Student& value) { return value.GetID().GetPacked() % 2 == 0; }
+};
+
+template <>
+struct BenchmarkKeys<Teacher> {
+    static const char* Name() { return "Teacher"; }
+    static Teacher Make(int i) {
+        static const std::string departments[] = {"Mathematics", "Physics", "Computer Science", "Chemistry"};
+        return Teacher(BenchmarkNames::Id(i), BenchmarkNames::First(i), BenchmarkNames::Middle(i),
+                       BenchmarkNames::Last(i), 0, departments[i % 4]);
+    }
+    static Teacher Map(const Teacher& value) { return value; }
+    static bool Keep(const Teacher& value) { return value.GetID().GetPacked() % 2 == 0; }
+};
+
+class BenchmarkReport {
+private:
+    std::vector<BenchmarkResult> results;
+
+public:
+    void add(const BenchmarkResult& result) {
+        results.push_back(result);
+    }
+
+    const std::vector<BenchmarkResult>& getResults() const {
+        return results;
+    }
+
+    void writeCsv(std::ostream& os) const {
+        os << "suite,container,type,distribution,operation,size,operations,seconds,ns_per_op\n";
+        for (const auto& r : results) {
+            os << r.suite << ',' << r.container << ',' << r.type << ',' << r.distribution << ','
+               << r.operation << ',' << r.size << ',' << r.operations << ','
+               << std::setprecision(9) << r.seconds << ',' << std::setprecision(6) << r.nanosPerOperation() << '\n';
+        }
+    }
+
+    void writeJson(std::ostream& os) const {
+        os << "[\n";
+        for (size_t i = 0; i < results.size(); ++i) {
+            const auto& r = results[i];
+            os << "  {\"suite\": \"" << r.suite << "\", \"container\": \"" << r.container
+               << "\", \"type\": \"" << r.type << "\", \"distribution\": \"" << r.distribution
+               << "\", \"operation\": \"" << r.operation << "\", \"size\": " << r.size
+               << ", \"operations\": " << r.operations
+               << ", \"seconds\": " << std::setprecision(9) << r.seconds
+               << ", \"ns_per_op\": " << std::setprecision(6) << r.nanosPerOperation() << "}"
+               << (i + 1 < results.size() ? ",\n" : "\n");
+        }
+        os << "]\n";
+    }
+};
+
+struct BenchmarkOptions {
+    std::vector<std::string> suites = {"tree", "set", "sequence"};
+    std::vector<std::string> types = {"int", "double", "string", "student", "teacher"};
+    std::vector<int> sizes = {1000, 10000, 100000, 1000000, 10000000};
+    std::vector<KeyDistribution> distributions = {
+        KeyDistribution::Random, KeyDistribution::Sorted, KeyDistribution::Adversarial
+    };
+    int probes = 1000;
+    unsigned seed = 42;
+    std::string format = "csv";
+    std::string outPath;
+
+    bool wants(const std::vector<std::string>& list, const std::string& name) const {
+        return std::find(list.begin(), list.end(), name) != list.end();
+    }
+
+    static std::vector<std::string> splitList(const std::string& text) {
+        std::vector<std::string> items;
+        size_t start = 0;
+        while (start <= text.size()) {
+            size_t end = text.find(',', start);
+            if (end == std::string::npos) end = text.size();
+            if (end > start) items.push_back(text.substr(start, end - start));
+            start = end + 1;
+        }
+        return items;
+    }
+
+    static long long parseNumber(const std::string& text, const char* option) {
+        size_t used = 0;
+        long long value = 0;
+        try {
+            value = std::stoll(text, &used);
+        } catch (const std::exception&) {
+            used = 0;
+        }
+        if (used != text.size() || value <= 0) {
+            throw std::invalid_argument(std::string("Invalid value for ") + option + ": " + text);
+        }
+        return value;
+    }
+
+    static BenchmarkOptions parse(int argc, char** argv) {
+        BenchmarkOptions options;
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            size_t eq = arg.find('=');
+            if (arg.compare(0, 2, "--") != 0 || eq == std::string::npos) {
+                throw std::invalid_argument("Expected --option=value, got: " + arg);
+            }
+            std::string key = arg.substr(2, eq - 2);
+            std::string value = arg.substr(eq + 1);
+
+            if (key == "suites") {
+                options.suites = splitList(value);
+            } else if (key == "types") {
+                options.types = splitList(value);
+            } else if (key == "sizes") {
+                options.sizes.clear();
+                for (const auto& item : splitList(value)) {
+                    long long size = parseNumber(item, "--sizes");
+                    if (size > 100000000) throw std::invalid_argument("Size too large: " + item);
+                    options.sizes.push_back(static_cast<int>(size));
+                }
+            } else if (key == "dist") {
+                options.distributions.clear();
+                for (const auto& item : splitList(value)) {
+                    if (item == "random") options.distributions.push_back(KeyDistribution::Random);
+                    else if (item == "sorted") options.distributions.push_back(KeyDistribution::Sorted);
+                    else if (item == "adversarial") options.distributions.push_back(KeyDistribution::Adversarial);
+                    else throw std::invalid_argument("Unknown distribution: " + item);
+                }
+            } else if (key == "probes") {
+                options.probes = static_cast<int>(std::min<long long>(parseNumber(value, "--probes"), 100000000));
+            } else if (key == "seed") {
+                options.seed = static_cast<unsigned>(parseNumber(value, "--seed"));
+            } else if (key == "format") {
+                if (value != "csv" && value != "json") throw std::invalid_argument("Unknown format: " + value);
+                options.format = value;
+            } else if (key == "out") {
+                options.outPath = value;
+            } else {
+                throw std::invalid_argument("Unknown option: --" + key);
+            }
+        }
+        return options;
+    }
+};
+
+class BenchmarkRunner {
+private:
+    const BenchmarkOptions& options;
+    BenchmarkReport& report;
+
+    // Results of timed lookups are folded in here so the optimiser cannot drop them.
+    long long sink;
+
+    template <typename Body>
+    static double timeSeconds(Body body) {
+        auto start = std::chrono::steady_clock::now();
+        body();
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    void record(const char* suite, const std::string& container, const char* type,
+                KeyDistribution distribution, const char* operation, int size,
+                long long operations, double seconds) {
+        report.add({suite, container, type, distributionName(distribution), operation,
+                    size, operations, seconds});
+    }
+
+    template <typename T>
+    static std::vector<T> makeKeys(int count, KeyDistribution distribution, std::mt19937& gen) {
+        std::vector<T> keys;
+        keys.reserve(count);
+        for (int i = 0; i < count; ++i) {
+            keys.push_back(BenchmarkKeys<T>::Make(i));
+        }
+
+        if (distribution == KeyDistribution::Random) {
+            std::shuffle(keys.begin(), keys.end(), gen);
+            return keys;
+        }
+
+        std::sort(keys.begin(), keys.end(), [](const T& a, const T& b) {
+            return ThreeWayCompare<T>()(a, b) < 0;
+        });
+        if (distribution == KeyDistribution::Sorted) {
+            return keys;
+        }
+
+        std::vector<T> zigzag;
+        zigzag.reserve(count);
+        for (int low = 0, high = count - 1; low <= high; ++low, --high) {
+            zigzag.push_back(keys[low]);
+            if (low != high) zigzag.push_back(keys[high]);
+        }
+        return zigzag;
+    }
+
+    // Positions for InsertAt/Get on a sequence that currently holds length elements.
+    static int probeIndex(KeyDistribution distribution, int probe, int length, std::mt19937& gen) {
+        if (length <= 0) return 0;
+        switch (distribution) {
+            case KeyDistribution::Random:
+                return std::uniform_int_distribution<int>(0, length - 1)(gen);
+            case KeyDistribution::Sorted:
+                return probe % length;
+            default:
+                return length / 2;
+        }
+    }
+
+    template <typename T>
+    void benchmarkTree(int size, KeyDistribution distribution) {
+        const char* type = BenchmarkKeys<T>::Name();
+        std::mt19937 gen(options.seed);
+        std::vector<T> keys = makeKeys<T>(size, distribution, gen);
+
+        AVLTree<T> tree;
+        record("tree", "AVLTree", type, distribution, "insert", size, size, timeSeconds([&] {
+            for (const T& key : keys) tree.insert(key);
+        }));
+
+        record("tree", "AVLTree", type, distribution, "contains", size, size, timeSeconds([&] {
+            for (const T& key : keys) sink += tree.contains(key);
+        }));
+
+        record("tree", "AVLTree", type, distribution, "traverse", size, size, timeSeconds([&] {
+            sink += tree.traverse().GetLength();
+        }));
+
+        record("tree", "AVLTree", type, distribution, "map", size, size, timeSeconds([&] {
+            AVLTree<T>* mapped = tree.map(BenchmarkKeys<T>::Map);
+            sink += mapped->size();
+            delete mapped;
+        }));
+
+        record("tree", "AVLTree", type, distribution, "where", size, size, timeSeconds([&] {
+            AVLTree<T>* filtered = tree.where(BenchmarkKeys<T>::Keep);
+            sink += filtered->size();
+            delete filtered;
+        }));
+
+        record("tree", "AVLTree", type, distribution, "remove", size, size, timeSeconds([&] {
+            for (const T& key : keys) tree.remove(key);
+        }));
+    }
+
+    template <typename T>
+    void benchmarkSet(int size, KeyDistribution distribution) {
+        const char* type = BenchmarkKeys<T>::Name();
+        std::mt19937 gen(options.seed);
+        std::vector<T> keys = makeKeys<T>(size, distribution, gen);
+
+        // The two operands share a third of their keys.
+        int third = size / 3;
+        Set<T> left, right;
+        record("set", "Set", type, distribution, "insert", size, size, timeSeconds([&] {
+            for (int i = 0; i < size; ++i) {
+                if (i < size - third) left.insert(keys[i]);
+                if (i >= third) right.insert(keys[i]);
+            }
+        }));
+
+        record("set", "Set", type, distribution, "contains", size, size, timeSeconds([&] {
+            for (const T& key : keys) sink += left.contains(key);
+        }));
+
+        long long operands = static_cast<long long>(left.size()) + right.size();
+        record("set", "Set", type, distribution, "union", size, operands, timeSeconds([&] {
+            Set<T>* result = left.unionWith(&right);
+            sink += result->size();
+            delete result;
+        }));
+
+        record("set", "Set", type, distribution, "intersection", size, operands, timeSeconds([&] {
+            Set<T>* result = left.intersectionWith(&right);
+            sink += result->size();
+            delete result;
+        }));
+
+        record("set", "Set", type, distribution, "difference", size, operands, timeSeconds([&] {
+            Set<T>* result = left.differenceWith(&right);
+            sink += result->size();
+            delete result;
+        }));
+
+        record("set", "Set", type, distribution, "map", size, left.size(), timeSeconds([&] {
+            sink += left.map(BenchmarkKeys<T>::Map).size();
+        }));
+
+        record("set", "Set", type, distribution, "where", size, left.size(), timeSeconds([&] {
+            sink += left.where(BenchmarkKeys<T>::Keep).size();
+        }));
+
+        record("set", "Set", type, distribution, "remove", size, size, timeSeconds([&] {
+            for (const T& key : keys) left.remove(key);
+        }));
+    }
+
+    template <typename T, typename Container, typename Factory>
+    void benchmarkSequence(const char* container, Factory create, int size, KeyDistribution distribution) {
+        const char* type = BenchmarkKeys<T>::Name();
+        std::mt19937 gen(options.seed);
+        std::vector<T> keys = makeKeys<T>(size, distribution, gen);
+        int probes = std::min(size, options.probes);
+
+        {
+            Container* prepended = create();
+            record("sequence", container, type, distribution, "Prepend", size, size, timeSeconds([&] {
+                for (const T& key : keys) prepended->Prepend(key);
+            }));
+            delete prepended;
+        }
+
+        Container* sequence = create();
+        record("sequence", container, type, distribution, "Append", size, size, timeSeconds([&] {
+            for (const T& key : keys) sequence->Append(key);
+        }));
+
+        std::vector<int> positions;
+        positions.reserve(probes);
+        for (int i = 0; i < probes; ++i) {
+            positions.push_back(probeIndex(distribution, i, size, gen));
+        }
+
+        record("sequence", container, type, distribution, "Get", size, probes, timeSeconds([&] {
+            const Container& view = *sequence;
+            for (int index : positions) sink += reinterpret_cast<std::uintptr_t>(&view.Get(index)) & 1;
+        }));
+
+        record("sequence", container, type, distribution, "InsertAt", size, probes, timeSeconds([&] {
+            for (int i = 0; i < probes; ++i) sequence->InsertAt(keys[i], positions[i]);
+        }));
+
+        record("sequence", container, type, distribution, "Map", size, sequence->GetLength(), timeSeconds([&] {
+            auto* mapped = sequence->Map(BenchmarkKeys<T>::Map);
+            sink += mapped->GetLength();
+            delete mapped;
+        }));
+
+        record("sequence", container, type, distribution, "Where", size, sequence->GetLength(), timeSeconds([&] {
+            auto* filtered = sequence->Where(BenchmarkKeys<T>::Keep);
+            sink += filtered->GetLength();
+            delete filtered;
+        }));
+
+        delete sequence;
+    }
+
+    template <typename T>
+    void benchmarkSequences(int size, KeyDistribution distribution) {
+        benchmarkSequence<T, MutableArraySequence<T>>("ArraySequence",
+            [] { return new MutableArraySequence<T>(); }, size, distribution);
+        benchmarkSequence<T, MutableListSequence<T>>("ListSequence",
+            [] { return new MutableListSequence<T>(); }, size, distribution);
+        benchmarkSequence<T, MutableSegmentedSequence<T>>("SegmentedSequence",
+            [] { return new MutableSegmentedSequence<T>(SegmentSize); }, size, distribution);
+    }
+
+    template <typename T>
+    void benchmarkType() {
+        for (int size : options.sizes) {
+            for (KeyDistribution distribution : options.distributions) {
+                if (options.wants(options.suites, "tree")) benchmarkTree<T>(size, distribution);
+                if (options.wants(options.suites, "set")) benchmarkSet<T>(size, distribution);
+                if (options.wants(options.suites, "sequence")) benchmarkSequences<T>(size, distribution);
+            }
+        }
+    }
+
+public:
+    static constexpr int SegmentSize = 256;
+
+    BenchmarkRunner(const BenchmarkOptions& options_, BenchmarkReport& report_)
+        : options(options_), report(report_), sink(0) {}
+
+    void runAll() {
+        if (options.wants(options.types, "int")) benchmarkType<int>();
+        if (options.wants(options.types, "double")) benchmarkType<double>();
+        if (options.wants(options.types, "string")) benchmarkType<std::string>();
+        if (options.wants(options.types, "student")) benchmarkType<Student>();
+        if (options.wants(options.types, "teacher")) benchmarkType<Teacher>();
+    }
+
+    long long getSink() const {
+        return sink;
+    }
+
+    // Entry point for a benchmark executable; returns the process exit code.
+    static int run(int argc, char** argv) {
+        try {
+            BenchmarkOptions options = BenchmarkOptions::parse(argc, argv);
+            BenchmarkReport report;
+            BenchmarkRunner runner(options, report);
+            runner.runAll();
+
+            std::ofstream file;
+            if (!options.outPath.empty()) {
+                file.open(options.outPath);
+                if (!file) throw std::runtime_error("Cannot open output file: " + options.outPath);
+            }
+            std::ostream& out = options.outPath.empty() ? std::cout : file;
+
+            if (options.format == "json") report.writeJson(out);
+            else report.writeCsv(out);
+
+            std::cerr << "checksum " << runner.getSink() << "\n";
+            return 0;
+        } catch (const std::exception& e) {
+            std::cerr << "Benchmark error: " << e.what() << "\n";
+            return 1;
+        }
+    }
+};
@@ -0,0 +1,1191 @@
+#pragma once
+#include "AVLTree.hpp"
+#include "Set.hpp"
+#include "Person.hpp"
+#include "PersonLoader.hpp"
+#include "PersonStore.hpp"
+#include "Benchmark.hpp"
+#include "Sequence/RopeSequence.hpp"
+#include "Sequence/SegmentedSequence.hpp"
+#include "Sequence/SequenceView.hpp"
+#include "Sequence/ThreadPool.hpp"
+#include "Sequence/UnrolledListSequence.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <random>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+
+// Non-interactive counterpart to AVLTreeTester and SetTester: replays random
+// insert/remove/contains streams against AVLTree and Set and checks every answer
+// against std::set. After each batch the tree invariants are validated, the contents
+// are compared in order, and union/intersection/difference/symmetric difference are
+// checked against the std:: set algorithms.
+//
+// The sequences get the same treatment against std::vector: random appends, prepends,
+// inserts, removals, writes and concatenations, plus RemoveRange, Compact and slices on
+// SegmentedSequence (with array and list directories), SplitAt and Join on
+// RopeSequence, and checks that older versions of ImmutableArraySequence and
+// ImmutableUnrolledListSequence are left untouched. DynamicArray is driven directly
+// with std::string elements to exercise its gap moves on a non-trivial type.
+//
+// The --checks groups cover the rest of the library. "parallel" runs
+// ThreadPool and the parallel Map/Where/Reduce/zip/unzip of ArraySequence and
+// SegmentedSequence against their sequential versions, including empty inputs, a grain
+// of one and callables that throw. "views" compares SequenceView pipelines (Map, Where,
+// Zip, Take, Skip, Collect, CollectInto) over every container with the materialised
+// results and checks that a pipeline stops reading its source once the sink is done.
+// "store" replays random inserts and removals against PersonStore and a Set of
+// Students or Teachers, switching the secondary indexes on and off between queries.
+// "loader" writes files to the temporary directory and reads them with PersonLoader:
+// quoting, "" escapes, CRLF, header detection, tab and comma files, malformed lines and
+// lines longer than the read buffer.
+//
+//     HeadlessTester::run(argc, argv)
+//
+// Options:
+//     --types=int,double,string,student,teacher
+//     --sequences=dynamic,array,list,segmented,segmented-list,rope,persistent,
+//                 persistent-unrolled,unrolled
+//     --checks=parallel,views,store,loader
+//     --ops=N        operations per type and per sequence (default 1000000)
+//     --batch=N      operations between full checks (default 10000)
+//     --keys=N       size of the key universe, which sets the hit rate (default 65536)
+//     --length=N     length the sequences hover around (default 1024)
+//     --seed=N
+//
+// Returns 0 when every check passes and 1 on the first mismatch or invalid option.
+
+struct HeadlessTestOptions {
+    std::vector<std::string> types = {"int", "double", "string", "student", "teacher"};
+    std::vector<std::string> sequences = {"dynamic", "array", "list", "segmented", "segmented-list", "rope", "persistent",
+                                          "persistent-unrolled", "unrolled"};
+    std::vector<std::string> checks = {"parallel", "views", "store", "loader"};
+    long long operations = 1000000;
+    int batch = 10000;
+    int keys = 65536;
+    int length = 1024;
+    unsigned seed = 42;
+
+    static HeadlessTestOptions parse(int argc, char** argv) {
+        HeadlessTestOptions options;
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            size_t eq = arg.find('=');
+            if (arg.compare(0, 2, "--") != 0 || eq == std::string::npos) {
+                throw std::invalid_argument("Expected --option=value, got: " + arg);
+            }
+            std::string key = arg.substr(2, eq - 2);
+            std::string value = arg.substr(eq + 1);
+
+            if (key == "types") {
+                options.types = BenchmarkOptions::splitList(value);
+            } else if (key == "sequences") {
+                options.sequences = BenchmarkOptions::splitList(value);
+            } else if (key == "checks") {
+                options.checks = BenchmarkOptions::splitList(value);
+            } else if (key == "ops") {
+                options.operations = BenchmarkOptions::parseNumber(value, "--ops");
+            } else if (key == "batch") {
+                options.batch = static_cast<int>(std::min<long long>(BenchmarkOptions::parseNumber(value, "--batch"), 1 << 30));
+            } else if (key == "keys") {
+                options.keys = static_cast<int>(std::min<long long>(BenchmarkOptions::parseNumber(value, "--keys"), 1 << 30));
+            } else if (key == "length") {
+                options.length = static_cast<int>(std::min<long long>(BenchmarkOptions::parseNumber(value, "--length"), 1 << 30));
+            } else if (key == "seed") {
+                options.seed = static_cast<unsigned>(BenchmarkOptions::parseNumber(value, "--seed"));
+            } else {
+                throw std::invalid_argument("Unknown option: --" + key);
+            }
+        }
+        return options;
+    }
+};
+
+class HeadlessTester {
+private:
+    template <typename T>
+    struct Less {
+        bool operator()(const T& a, const T& b) const {
+            return ThreeWayCompare<T>()(a, b) < 0;
+        }
+    };
+
+    template <typename T>
+    using Reference = std::set<T, Less<T>>;
+
+    const HeadlessTestOptions& options;
+
+    static void check(bool condition, const std::string& what, const char* type, long long op) {
+        if (!condition) {
+            throw std::logic_error(std::string(type) + ": " + what + " mismatch after " + std::to_string(op) + " operations");
+        }
+    }
+
+    template <typename T>
+    static bool sameContents(const AVLTree<T>& tree, const Reference<T>& reference) {
+        if (tree.size() != static_cast<int>(reference.size())) return false;
+
+        auto elements = tree.traverse();
+        auto expected = reference.begin();
+        for (const auto& pair : elements) {
+            if (ThreeWayCompare<T>()(pair.first, *expected) != 0) return false;
+            ++expected;
+        }
+        return true;
+    }
+
+    template <typename T>
+    void checkSetOperations(const Set<T>& set, const Reference<T>& reference, std::mt19937& gen, long long op) {
+        const char* type = BenchmarkKeys<T>::Name();
+        std::uniform_int_distribution<int> key(0, options.keys - 1);
+
+        Set<T> other;
+        Reference<T> otherReference;
+        int count = std::min(options.batch, options.keys);
+        for (int i = 0; i < count; ++i) {
+            T value = BenchmarkKeys<T>::Make(key(gen));
+            other.insert(value);
+            otherReference.insert(value);
+        }
+
+        auto verify = [&](Set<T>* result, const Reference<T>& want, const char* what) {
+            result->getTree()->validate();
+            bool same = sameContents(*result->getTree(), want);
+            delete result;
+            check(same, what, type, op);
+        };
+
+        auto expected = [&](auto algorithm) {
+            Reference<T> result;
+            algorithm(reference.begin(), reference.end(), otherReference.begin(), otherReference.end(),
+                      std::inserter(result, result.end()), Less<T>());
+            return result;
+        };
+
+        verify(set.unionWith(&other), expected([](auto... args) {
+            return std::set_union(args...);
+        }), "union");
+        verify(set.intersectionWith(&other), expected([](auto... args) {
+            return std::set_intersection(args...);
+        }), "intersection");
+        verify(set.differenceWith(&other), expected([](auto... args) {
+            return std::set_difference(args...);
+        }), "difference");
+        verify(set.symmetricDifferenceWith(&other), expected([](auto... args) {
+            return std::set_symmetric_difference(args...);
+        }), "symmetric difference");
+    }
+
+    template <typename T>
+    void runType() {
+        const char* type = BenchmarkKeys<T>::Name();
+        std::mt19937 gen(options.seed);
+        std::uniform_int_distribution<int> key(0, options.keys - 1);
+        std::uniform_int_distribution<int> action(0, 2);
+
+        Set<T> set;
+        AVLTree<T> tree;
+        Reference<T> reference;
+
+        double seconds = 0;
+        long long done = 0;
+        while (done < options.operations) {
+            long long batch = std::min<long long>(options.batch, options.operations - done);
+
+            auto start = std::chrono::steady_clock::now();
+            for (long long i = 0; i < batch; ++i) {
+                T value = BenchmarkKeys<T>::Make(key(gen));
+                switch (action(gen)) {
+                    case 0:
+                        set.insert(value);
+                        tree.insert(value);
+                        reference.insert(value);
+                        break;
+                    case 1:
+                        set.remove(value);
+                        tree.remove(value);
+                        reference.erase(value);
+                        break;
+                    default: {
+                        bool expected = reference.count(value) != 0;
+                        check(set.contains(value) == expected, "Set::contains", type, done + i);
+                        check(tree.contains(value) == expected, "AVLTree::contains", type, done + i);
+                    }
+                }
+            }
+            seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            done += batch;
+
+            tree.validate();
+            set.getTree()->validate();
+            check(sameContents(tree, reference), "AVLTree contents", type, done);
+            check(sameContents(*set.getTree(), reference), "Set contents", type, done);
+            checkSetOperations(set, reference, gen, done);
+        }
+
+        std::cout << type << ": " << done << " operations passed, final size " << set.size()
+                  << ", " << static_cast<long long>(seconds > 0 ? done / seconds : 0) << " ops/s\n";
+    }
+
+    using Model = std::vector<int>;
+
+    static bool sameContents(const Sequence<int>& sequence, const Model& model) {
+        if (sequence.GetLength() != static_cast<int>(model.size())) return false;
+
+        auto expected = model.begin();
+        return sequence.ForEachWhile([&](int item) {
+            return item == *expected++;
+        });
+    }
+
+    // Position in [0, length], or in [0, length) when an element must exist there.
+    static int position(std::mt19937& gen, int length, bool existing) {
+        return static_cast<int>(gen() % static_cast<unsigned>(existing ? length : length + 1));
+    }
+
+    static int randomValue(std::mt19937& gen) {
+        return static_cast<int>(gen() >> 1);
+    }
+
+    // Draws the next edit: 0-2 and 6 grow the sequence, 3 shrinks it, 4 writes, 5 reads
+    // and 7 is left to the caller. Growing edits become removals while the sequence is
+    // longer than --length, so its length hovers around that value.
+    int nextAction(std::mt19937& gen, std::size_t length) const {
+        int action = static_cast<int>(gen() % 8);
+        bool grows = action <= 2 || action == 6;
+        if (grows && static_cast<int>(length) > options.length) return 3;
+        if (length == 0 && (action == 3 || action == 4 || action == 5)) return 0;
+        return action;
+    }
+
+    static MutableArraySequence<int> randomChunk(std::mt19937& gen, Model& values) {
+        MutableArraySequence<int> chunk;
+        values.clear();
+        int count = static_cast<int>(gen() % 9);
+        for (int i = 0; i < count; ++i) {
+            values.push_back(randomValue(gen));
+            chunk.Append(values.back());
+        }
+        return chunk;
+    }
+
+    template <typename Body>
+    void runBatches(const char* name, Body body, const std::function<int()>& length) {
+        double seconds = 0;
+        long long done = 0;
+        while (done < options.operations) {
+            long long batch = std::min<long long>(options.batch, options.operations - done);
+
+            auto start = std::chrono::steady_clock::now();
+            body(batch, done);
+            seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            done += batch;
+        }
+
+        std::cout << name << ": " << done << " operations passed, final length " << length()
+                  << ", " << static_cast<long long>(seconds > 0 ? done / seconds : 0) << " ops/s\n";
+    }
+
+    // Drives a mutable sequence through the Sequence interface; extra(gen, model, op)
+    // applies the edits only this container has.
+    template <typename SequenceType, typename Extra>
+    void runSequence(const char* name, SequenceType& sequence, Extra extra) {
+        std::mt19937 gen(options.seed);
+        Model model;
+        Model chunkValues;
+
+        runBatches(name, [&](long long batch, long long done) {
+            for (long long i = 0; i < batch; ++i) {
+                long long op = done + i;
+                int length = static_cast<int>(model.size());
+                int value = randomValue(gen);
+
+                switch (nextAction(gen, model.size())) {
+                    case 0:
+                        sequence.Append(value);
+                        model.push_back(value);
+                        break;
+                    case 1:
+                        sequence.Prepend(value);
+                        model.insert(model.begin(), value);
+                        break;
+                    case 2: {
+                        // InsertAt takes an existing position; the end is reached with Append.
+                        int index = length ? position(gen, length, true) : 0;
+                        if (length) sequence.InsertAt(value, index); else sequence.Append(value);
+                        model.insert(model.begin() + index, value);
+                        break;
+                    }
+                    case 3: {
+                        int index = position(gen, length, true);
+                        sequence.RemoveAt(index);
+                        model.erase(model.begin() + index);
+                        break;
+                    }
+                    case 4: {
+                        int index = position(gen, length, true);
+                        sequence.Get(index) = value;
+                        model[index] = value;
+                        break;
+                    }
+                    case 5: {
+                        int index = position(gen, length, true);
+                        check(sequence.Get(index) == model[index], "Get", name, op);
+                        break;
+                    }
+                    case 6: {
+                        MutableArraySequence<int> chunk = randomChunk(gen, chunkValues);
+                        sequence.Concat(&chunk);
+                        model.insert(model.end(), chunkValues.begin(), chunkValues.end());
+                        break;
+                    }
+                    default:
+                        extra(gen, model, op);
+                }
+            }
+            check(sameContents(sequence, model), "contents", name, done + batch);
+        }, [&] { return sequence.GetLength(); });
+    }
+
+    // Directory is the container holding the segment pointers; a list directory makes
+    // every positional segment lookup O(segments), so whole walks must not use them.
+    template <template <typename> class Directory>
+    void runSegmented(const char* name) {
+        MutableSegmentedSequence<int, MutableArraySequence, Directory> sequence(16);
+        runSequence(name, sequence, [&](std::mt19937& gen, Model& model, long long op) {
+            if (model.empty()) return;
+
+            int from = position(gen, static_cast<int>(model.size()), true);
+            int to = std::min(static_cast<int>(model.size()) - 1, from + static_cast<int>(gen() % 8));
+            switch (gen() % 4) {
+                case 0:
+                    sequence.Compact();
+                    check(sameContents(sequence, model), "Compact", name, op);
+                    break;
+                case 1: {
+                    std::unique_ptr<Sequence<int>> slice(sequence.GetSubsequence(to, from));
+                    check(sameContents(*slice, Model(model.rbegin() + (model.size() - 1 - to), model.rend() - from)),
+                          "GetSubsequence", name, op);
+                    break;
+                }
+                default:
+                    sequence.RemoveRange(from, to);
+                    model.erase(model.begin() + from, model.begin() + to + 1);
+            }
+        });
+    }
+
+    void runRope() {
+        MutableRopeSequence<int> sequence(16);
+        runSequence("rope", sequence, [&](std::mt19937& gen, Model& model, long long op) {
+            int index = position(gen, static_cast<int>(model.size()), false);
+            std::unique_ptr<MutableRopeSequence<int>> tail(sequence.SplitAt(index));
+
+            check(sameContents(sequence, Model(model.begin(), model.begin() + index)), "SplitAt head", "rope", op);
+            check(sameContents(*tail, Model(model.begin() + index, model.end())), "SplitAt tail", "rope", op);
+            sequence.Join(*tail);
+            check(tail->GetLength() == 0, "Join source", "rope", op);
+        });
+    }
+
+    // Every edit yields a new version. A snapshot taken at the start of each batch must
+    // still hold its old contents at the end, whatever was written to later versions.
+    template <typename Immutable>
+    void runPersistent(const char* name) {
+        std::mt19937 gen(options.seed);
+        auto current = std::make_unique<Immutable>();
+        Model model;
+        Model chunkValues;
+
+        auto advance = [&](Sequence<int>* next) {
+            current.reset(static_cast<Immutable*>(next));
+        };
+
+        runBatches(name, [&](long long batch, long long done) {
+            Immutable snapshot(*current);
+            Model snapshotModel = model;
+
+            for (long long i = 0; i < batch; ++i) {
+                long long op = done + i;
+                int length = static_cast<int>(model.size());
+                int value = randomValue(gen);
+
+                switch (nextAction(gen, model.size())) {
+                    case 0:
+                        advance(current->Append(value));
+                        model.push_back(value);
+                        break;
+                    case 1:
+                        advance(current->Prepend(value));
+                        model.insert(model.begin(), value);
+                        break;
+                    case 2: {
+                        int index = length ? position(gen, length, true) : 0;
+                        advance(length ? current->InsertAt(value, index) : current->Append(value));
+                        model.insert(model.begin() + index, value);
+                        break;
+                    }
+                    case 3: {
+                        int index = position(gen, length, true);
+                        advance(current->RemoveAt(index));
+                        model.erase(model.begin() + index);
+                        break;
+                    }
+                    case 4: {
+                        int index = position(gen, length, true);
+                        current->Get(index) = value;
+                        model[index] = value;
+                        break;
+                    }
+                    case 6: {
+                        MutableArraySequence<int> chunk = randomChunk(gen, chunkValues);
+                        advance(current->Concat(&chunk));
+                        model.insert(model.end(), chunkValues.begin(), chunkValues.end());
+                        break;
+                    }
+                    default: {
+                        if (length == 0) break;
+                        int index = position(gen, length, true);
+                        const Immutable& version = *current;
+                        check(version.Get(index) == model[index], "Get", name, op);
+                    }
+                }
+            }
+            check(sameContents(*current, model), "contents", name, done + batch);
+            check(sameContents(snapshot, snapshotModel), "snapshot contents", name, done + batch);
+        }, [&] { return current->GetLength(); });
+    }
+
+    void runDynamicArray() {
+        const char* name = "dynamic";
+        std::mt19937 gen(options.seed);
+        DynamicArray<std::string> array;
+        std::vector<std::string> model;
+
+        auto text = [&gen] {
+            // Long enough to live on the heap, so moves and copies are observable.
+            return std::to_string(randomValue(gen)) + std::string(24, '#');
+        };
+
+        runBatches(name, [&](long long batch, long long done) {
+            for (long long i = 0; i < batch; ++i) {
+                long long op = done + i;
+                int length = static_cast<int>(model.size());
+
+                switch (nextAction(gen, model.size())) {
+                    case 0:
+                        model.push_back(text());
+                        array.EmplaceBack(model.back());
+                        break;
+                    case 1:
+                        model.insert(model.begin(), text());
+                        array.EmplaceFront(model.front());
+                        break;
+                    case 2: {
+                        int index = position(gen, length, false);
+                        model.insert(model.begin() + index, text());
+                        array.EmplaceAt(index, model[index]);
+                        break;
+                    }
+                    case 3: {
+                        int index = position(gen, length, true);
+                        array.RemoveAt(index);
+                        model.erase(model.begin() + index);
+                        break;
+                    }
+                    case 4: {
+                        int index = position(gen, length, true);
+                        model[index] = text();
+                        array.Set(model[index], index);
+                        break;
+                    }
+                    case 5: {
+                        int index = position(gen, length, true);
+                        check(array.Get(index) == model[index], "Get", name, op);
+                        break;
+                    }
+                    case 6: {
+                        int index = position(gen, length, false);
+                        std::vector<std::string> items(gen() % 9);
+                        for (std::string& item : items) item = text();
+                        array.InsertRange(index, items.data(), static_cast<int>(items.size()));
+                        model.insert(model.begin() + index, items.begin(), items.end());
+                        break;
+                    }
+                    default:
+                        if (gen() % 64 == 0) {
+                            array.ShrinkToFit();
+                        } else if (length > 0) {
+                            // Inserting an element of the array itself must still see its old value.
+                            int from = position(gen, length, true);
+                            int index = position(gen, length, false);
+                            model.insert(model.begin() + index, model[from]);
+                            array.EmplaceAt(index, array.Get(from));
+                        }
+                }
+            }
+            bool same = array.GetSize() == static_cast<int>(model.size())
+                && std::equal(model.begin(), model.end(), array.GetData());
+            check(same, "contents", name, done + batch);
+        }, [&] { return array.GetSize(); });
+    }
+
+    template <typename T>
+    static std::vector<T> contents(const Sequence<T>& sequence) {
+        std::vector<T> items;
+        items.reserve(sequence.GetLength());
+        sequence.ForEach([&](const T& item) {
+            items.push_back(item);
+        });
+        return items;
+    }
+
+    // Expects body to throw std::runtime_error out of the pool.
+    template <typename Body>
+    static void checkThrows(Body body, const std::string& what, const char* name, long long op) {
+        bool thrown = false;
+        try {
+            body();
+        } catch (const std::runtime_error&) {
+            thrown = true;
+        }
+        check(thrown, what + " exception", name, op);
+    }
+
+    // Each chunk of ParallelForRange must be visited exactly once, also when the
+    // grain is a single item, when there are no items and from inside another task.
+    static void checkThreadPool(ThreadPool& pool) {
+        const char* name = "thread pool";
+        for (int count : {0, 1, 5, 1000, ThreadPool::DefaultGrain * 3 + 1}) {
+            for (int grain : {1, 7, ThreadPool::DefaultGrain}) {
+                DynamicArray<int> visits(count);
+                int* visited = visits.GetData();
+                pool.ParallelForRange(count, grain, [&](int begin, int end) {
+                    for (int i = begin; i < end; ++i) ++visited[i];
+                });
+                check(std::all_of(visited, visited + count, [](int v) { return v == 1; }),
+                      "ParallelForRange grain " + std::to_string(grain), name, count);
+                check(pool.ChunkCount(count, grain) <= 4 * (pool.GetThreadCount() + 1), "ChunkCount", name, count);
+            }
+        }
+
+        DynamicArray<int> nested(64 * 64);
+        int* cells = nested.GetData();
+        pool.ParallelFor(64, [&](int row) {
+            pool.ParallelForRange(64, 1, [&](int begin, int end) {
+                for (int column = begin; column < end; ++column) ++cells[row * 64 + column];
+            });
+        });
+        check(std::all_of(cells, cells + 64 * 64, [](int v) { return v == 1; }), "nested ParallelFor", name, 64 * 64);
+
+        // Every task still runs when some of them throw, and the pool stays usable.
+        std::atomic<int> ran(0);
+        checkThrows([&] {
+            pool.ParallelFor(32, [&](int task) {
+                ++ran;
+                if (task % 5 == 0) throw std::runtime_error("task");
+            });
+        }, "ParallelFor", name, 32);
+        check(ran.load() == 32, "ParallelFor after exception", name, 32);
+    }
+
+    // Compares the parallel algorithms of one container with its sequential Map, Where
+    // and Reduce, then checks that a throwing mapper, predicate or reducer surfaces.
+    template <typename Container>
+    static void checkParallelAlgorithms(const char* name, const Container& sequence, ThreadPool& pool) {
+        int length = sequence.GetLength();
+        auto mapper = [](int item, int index) { return item ^ index; };
+        auto predicate = [](int item) { return item % 3 == 0; };
+        auto sum = [](int a, int b) { return static_cast<int>(static_cast<unsigned>(a) + static_cast<unsigned>(b)); };
+        auto last = [](int, int b) { return b; };
+
+        std::unique_ptr<Sequence<int>> mapped(sequence.Map(mapper));
+        std::unique_ptr<Sequence<int>> parallelMapped(sequence.ParallelMap(mapper, pool));
+        check(contents(*parallelMapped) == contents(*mapped), "ParallelMap", name, length);
+
+        std::unique_ptr<Sequence<int>> kept(sequence.Where(predicate));
+        std::unique_ptr<Sequence<int>> parallelKept(sequence.ParallelWhere(predicate, pool));
+        check(contents(*parallelKept) == contents(*kept), "ParallelWhere", name, length);
+
+        check(sequence.ParallelReduce(sum, 17, pool) == sequence.Reduce(sum, 17), "ParallelReduce sum", name, length);
+        check(sequence.ParallelReduce(last, -1, pool) == sequence.Reduce(last, -1), "ParallelReduce order", name, length);
+
+        if (length == 0) return;
+
+        int poison = sequence.Get(length / 2);
+        checkThrows([&] {
+            std::unique_ptr<Sequence<int>> result(sequence.ParallelMap([poison](int item) {
+                if (item == poison) throw std::runtime_error("mapper");
+                return item;
+            }, pool));
+        }, "ParallelMap", name, length);
+        checkThrows([&] {
+            std::unique_ptr<Sequence<int>> result(sequence.ParallelWhere([poison](int item) {
+                if (item == poison) throw std::runtime_error("predicate");
+                return true;
+            }, pool));
+        }, "ParallelWhere", name, length);
+        checkThrows([&] {
+            sequence.ParallelReduce([](int, int) -> int { throw std::runtime_error("reducer"); }, 0, pool);
+        }, "ParallelReduce", name, length);
+    }
+
+    template <typename First, typename Second, typename Zipped>
+    static void checkParallelZip(const char* name, const First& first, const Second& second,
+                                 const Zipped& zipped, ThreadPool& pool) {
+        int length = zipped.GetLength();
+
+        std::unique_ptr<Sequence<std::pair<int, int>>> pairs(zip<int, int>(&first, &second));
+        std::unique_ptr<Sequence<std::pair<int, int>>> parallelPairs(parallelZip(&first, &second, pool));
+        check(contents(*parallelPairs) == contents(*pairs), "parallelZip", name, length);
+
+        auto columns = unzip<int, int>(&zipped);
+        auto parallelColumns = parallelUnzip(&zipped, pool);
+        std::unique_ptr<Sequence<int>> firsts(columns.first), seconds(columns.second);
+        std::unique_ptr<Sequence<int>> parallelFirsts(parallelColumns.first), parallelSeconds(parallelColumns.second);
+        check(contents(*parallelFirsts) == contents(*firsts), "parallelUnzip first", name, length);
+        check(contents(*parallelSeconds) == contents(*seconds), "parallelUnzip second", name, length);
+    }
+
+    // A pool of its own guarantees several workers whatever the machine. The lengths
+    // cover the empty case, a single chunk and many chunks around DefaultGrain; segments
+    // of DefaultGrain items make every segment a task of its own.
+    void runParallel() {
+        std::mt19937 gen(options.seed);
+        ThreadPool pool(3);
+        checkThreadPool(pool);
+
+        const int grain = ThreadPool::DefaultGrain;
+        int checked = 0;
+        for (int length : {0, 1, 7, grain - 1, grain + 1, 9 * grain + 5}) {
+            Model values(length);
+            for (int& value : values) value = randomValue(gen);
+            Model others(length / 2 + 1);
+            for (int& value : others) value = randomValue(gen);
+
+            MutableArraySequence<int> array(values.data(), length);
+            MutableArraySequence<int> otherArray(others.data(), static_cast<int>(others.size()));
+            MutableArraySequence<std::pair<int, int>> zippedArray;
+            for (int i = 0; i < length; ++i) zippedArray.Append(std::make_pair(values[i], ~values[i]));
+
+            checkParallelAlgorithms("parallel array", array, pool);
+            checkParallelZip("parallel array", array, otherArray, zippedArray, pool);
+
+            for (int segmentSize : {16, grain}) {
+                MutableSegmentedSequence<int, MutableArraySequence, MutableArraySequence> segmented(
+                    values.data(), length, segmentSize);
+                MutableSegmentedSequence<int, MutableArraySequence, MutableListSequence> otherSegmented(
+                    others.data(), static_cast<int>(others.size()), segmentSize == 16 ? grain : 16);
+                MutableSegmentedSequence<std::pair<int, int>, MutableArraySequence, MutableArraySequence> zippedSegmented(
+                    zippedArray, segmentSize);
+
+                // Uneven segments, so the tasks do not all get the same amount of work.
+                for (int i = 0; i < length / 8; ++i) {
+                    segmented.RemoveAt(position(gen, segmented.GetLength(), true));
+                    zippedSegmented.RemoveAt(position(gen, zippedSegmented.GetLength(), true));
+                }
+
+                checkParallelAlgorithms("parallel segmented", segmented, pool);
+                checkParallelZip("parallel segmented", segmented, otherSegmented, zippedSegmented, pool);
+            }
+            ++checked;
+        }
+
+        std::cout << "parallel: " << checked << " lengths passed on " << pool.GetThreadCount() + 1 << " threads\n";
+    }
+
+    // Runs viewOf pipelines over one container and compares them with the results of the
+    // materialised Map and Where, sliced or zipped on the model side.
+    template <typename Container>
+    void checkViews(const char* name, const Container& sequence, std::mt19937& gen, long long op) {
+        auto mapper = [](int item) { return static_cast<int>(static_cast<unsigned>(item) * 3u + 1u); };
+        auto predicate = [](int item) { return item % 4 != 0; };
+
+        std::unique_ptr<Sequence<int>> mapped(sequence.Map(mapper));
+        std::unique_ptr<Sequence<int>> kept(mapped->Where(predicate));
+        Model expected = contents(*kept);
+        int length = static_cast<int>(expected.size());
+        auto pipeline = viewOf(sequence).Map(mapper).Where(predicate);
+
+        std::unique_ptr<MutableArraySequence<int>> collected(pipeline.Collect());
+        check(contents(*collected) == expected, "view Collect", name, op);
+        std::unique_ptr<MutableListSequence<int>> collectedList(pipeline.template Collect<MutableListSequence<int>>());
+        check(contents(*collectedList) == expected, "view Collect into a list", name, op);
+
+        // CollectInto appends after whatever the target already holds.
+        Model prefix;
+        MutableArraySequence<int> target = randomChunk(gen, prefix);
+        prefix.insert(prefix.end(), expected.begin(), expected.end());
+        check(contents(pipeline.CollectInto(target)) == prefix, "view CollectInto", name, op);
+
+        check(pipeline.Count() == length, "view Count", name, op);
+        auto sum = [](int a, int b) { return static_cast<int>(static_cast<unsigned>(a) + static_cast<unsigned>(b)); };
+        check(pipeline.Reduce(sum, 5) == kept->Reduce(sum, 5), "view Reduce", name, op);
+
+        int skip = static_cast<int>(gen() % (length + 3));
+        int take = static_cast<int>(gen() % (length + 3));
+        Model skipped(expected.begin() + std::min(skip, length), expected.end());
+        Model window(skipped.begin(), skipped.begin() + std::min<int>(take, skipped.size()));
+        std::unique_ptr<Sequence<int>> taken(pipeline.Take(take).Collect());
+        check(contents(*taken) == Model(expected.begin(), expected.begin() + std::min(take, length)), "view Take", name, op);
+        std::unique_ptr<Sequence<int>> dropped(pipeline.Skip(skip).Collect());
+        check(contents(*dropped) == skipped, "view Skip", name, op);
+        std::unique_ptr<Sequence<int>> sliced(pipeline.Skip(skip).Take(take).Collect());
+        check(contents(*sliced) == window, "view Skip and Take", name, op);
+
+        Model otherValues;
+        MutableArraySequence<int> other = randomChunk(gen, otherValues);
+        std::unique_ptr<Sequence<std::pair<int, int>>> zipped(zip<int, int>(kept.get(), &other));
+        std::unique_ptr<Sequence<std::pair<int, int>>> viewZipped(pipeline.Zip(other).Collect());
+        check(contents(*viewZipped) == contents(*zipped), "view Zip", name, op);
+        check(pipeline.Zip(other).Run([](const std::pair<int, int>&) { return true; }), "view Zip end", name, op);
+
+        // Early termination: the source is read no further than the sink asked for.
+        int calls = 0;
+        auto counted = viewOf(sequence).Map([&calls](int item) {
+            ++calls;
+            return item;
+        });
+        int available = sequence.GetLength();
+        int stop = available ? 1 + static_cast<int>(gen() % available) : 0;
+        int visited = 0;
+        bool finished = counted.Run([&](int) { return ++visited < stop; });
+        check(finished == (available == 0) && calls == stop && visited == stop, "view early stop", name, op);
+
+        calls = 0;
+        check(counted.Take(take).Count() == std::min(take, available) && calls == std::min(take, available),
+              "view Take early stop", name, op);
+
+        Set<int> set;
+        set.insertAll(pipeline);
+        Reference<int> reference(expected.begin(), expected.end());
+        check(sameContents(*set.getTree(), reference), "view insertAll", name, op);
+
+        bool rejected = false;
+        try {
+            pipeline.Take(-1);
+        } catch (const std::invalid_argument&) {
+            rejected = true;
+        }
+        check(rejected, "view Take(-1)", name, op);
+    }
+
+    // Random short sequences in every container, viewed both through their concrete
+    // type and through Sequence<int>&.
+    void runViews() {
+        std::mt19937 gen(options.seed);
+        const int rounds = 200;
+
+        for (int round = 0; round < rounds; ++round) {
+            Model values(gen() % 48);
+            for (int& value : values) value = randomValue(gen);
+            int length = static_cast<int>(values.size());
+
+            MutableArraySequence<int> array(values.data(), length);
+            MutableListSequence<int> list(values.data(), length);
+            MutableSegmentedSequence<int, MutableArraySequence, MutableListSequence> segmented(values.data(), length, 4);
+            MutableUnrolledListSequence<int> unrolled(values.data(), length);
+            MutableRopeSequence<int> rope(values.data(), length, 4);
+            ImmutableArraySequence<int> persistent(values.data(), length);
+
+            checkViews("view array", array, gen, round);
+            checkViews("view list", list, gen, round);
+            checkViews("view segmented", segmented, gen, round);
+            checkViews("view unrolled", unrolled, gen, round);
+            checkViews("view rope", rope, gen, round);
+            checkViews("view persistent", persistent, gen, round);
+            checkViews("view Sequence&", static_cast<const Sequence<int>&>(segmented), gen, round);
+        }
+
+        std::cout << "views: " << rounds << " rounds passed\n";
+    }
+
+    static time_t birthDateOf(int key) {
+        return static_cast<time_t>(key % 97) * 86400;
+    }
+
+    // Every field is a function of key, so two rows with the same ID are the same
+    // record and the store's duplicate-ID rule agrees with the Set.
+    template <typename Row>
+    static Row makePerson(int key) {
+        Row base = BenchmarkKeys<Row>::Make(key);
+        return PersonRole<Row>::Make(base.GetID(), base.GetFirstName(), base.GetMiddleName(), base.GetLastName(),
+                                     birthDateOf(key), PersonRole<Row>::Get(base));
+    }
+
+    // Replays random inserts and removals against PersonStore and a Set of the same rows
+    // while the secondary indexes are switched on and off, so every query runs both
+    // through an index and as a column scan. Removals move the last row into the freed
+    // slot; after each batch every row must still be found under its own number.
+    template <typename Row>
+    void runStore() {
+        std::string label = std::string("store ") + BenchmarkKeys<Row>::Name();
+        const char* name = label.c_str();
+        std::mt19937 gen(options.seed);
+        // Small enough that the reference walk behind every query stays cheap.
+        int universe = std::max(2, std::min(options.keys, options.length / 4));
+
+        PersonStore<Row> store;
+        Set<Row> reference;
+        const PersonIndex kinds[] = {PersonIndex::LastName, PersonIndex::Role, PersonIndex::BirthDate};
+        bool indexed[] = {false, false, false};
+
+        // IDs of the rows a query returned against those of the reference rows it should
+        // match. Equality queries return rows in ascending row order with or without an index.
+        auto compare = [&](const MutableArraySequence<int>& found, auto matches, bool ascending,
+                           const char* what, long long op) {
+            std::vector<PersonID> actual;
+            bool ordered = true;
+            int previous = -1;
+            found.ForEach([&](int row) {
+                actual.push_back(store.GetRow(row).GetID());
+                ordered = ordered && row > previous;
+                previous = row;
+            });
+
+            std::vector<PersonID> expected;
+            reference.getTree()->traverse().ForEach([&](const std::pair<Row, int>& entry) {
+                if (matches(entry.first)) expected.push_back(entry.first.GetID());
+            });
+
+            std::sort(actual.begin(), actual.end());
+            std::sort(expected.begin(), expected.end());
+            check(actual == expected && (ordered || !ascending), what, name, op);
+        };
+
+        runBatches(name, [&](long long batch, long long done) {
+            for (long long i = 0; i < batch; ++i) {
+                long long op = done + i;
+                int key = static_cast<int>(gen() % universe);
+                Row person = makePerson<Row>(key);
+
+                switch (gen() % 16) {
+                    case 0: case 1: case 2: case 3: case 4: case 5: {
+                        bool expected = !reference.contains(person);
+                        check(store.Insert(person) == expected, "Insert", name, op);
+                        reference.insert(person);
+                        break;
+                    }
+                    case 6: case 7: case 8: case 9: case 10: {
+                        bool expected = reference.contains(person);
+                        check(store.Remove(person.GetID()) == expected, "Remove", name, op);
+                        reference.remove(person);
+                        break;
+                    }
+                    case 11: {
+                        int kind = static_cast<int>(gen() % 3);
+                        if (indexed[kind]) store.DisableIndex(kinds[kind]); else store.EnableIndex(kinds[kind]);
+                        indexed[kind] = !indexed[kind];
+                        break;
+                    }
+                    case 12: {
+                        int row = store.Find(person.GetID());
+                        bool expected = reference.contains(person);
+                        check(store.Contains(person.GetID()) == expected && (row >= 0) == expected, "Find", name, op);
+                        if (row >= 0) check(store.GetRow(row) == person, "GetRow", name, op);
+                        break;
+                    }
+                    case 13: {
+                        // Now and then a name no row has, which must match nothing.
+                        std::string lastName = gen() % 8 ? person.GetLastName() : std::string("Nobody");
+                        compare(store.FindByLastName(lastName), [&](const Row& row) {
+                            return row.GetLastName() == lastName;
+                        }, true, "FindByLastName", op);
+                        break;
+                    }
+                    case 14: {
+                        std::string role = PersonRole<Row>::Get(person);
+                        compare(store.FindByRole(role), [&](const Row& row) {
+                            return PersonRole<Row>::Get(row) == role;
+                        }, true, "FindByRole", op);
+                        break;
+                    }
+                    default: {
+                        int other = static_cast<int>(gen() % universe);
+                        time_t from = std::min(birthDateOf(key), birthDateOf(other));
+                        time_t to = std::max(birthDateOf(key), birthDateOf(other));
+                        compare(store.FindBornBetween(from, to), [&](const Row& row) {
+                            return from <= row.GetBirthDate() && row.GetBirthDate() <= to;
+                        }, false, "FindBornBetween", op);
+
+                        PersonID low = std::min(person.GetID(), BenchmarkNames::Id(other));
+                        PersonID high = std::max(person.GetID(), BenchmarkNames::Id(other));
+                        MutableArraySequence<int> ids = store.FindIDsBetween(low, high);
+                        compare(ids, [&](const Row& row) {
+                            return low <= row.GetID() && row.GetID() <= high;
+                        }, false, "FindIDsBetween", op);
+                        Model rows = contents(ids);
+                        check(std::is_sorted(rows.begin(), rows.end(), [&](int a, int b) {
+                            return store.GetRow(a).GetID() < store.GetRow(b).GetID();
+                        }), "FindIDsBetween order", name, op);
+                    }
+                }
+            }
+
+            bool same = store.GetSize() == reference.size();
+            for (int row = 0; row < store.GetSize() && same; ++row) {
+                Row stored = store.GetRow(row);
+                same = reference.contains(stored) && store.Find(stored.GetID()) == row;
+            }
+            check(same, "contents", name, done + batch);
+        }, [&] { return store.GetSize(); });
+    }
+
+    template <typename Row>
+    static bool sameRow(const Row& a, const Row& b) {
+        return a.GetID() == b.GetID() && a.GetFirstName() == b.GetFirstName() && a.GetMiddleName() == b.GetMiddleName()
+            && a.GetLastName() == b.GetLastName() && a.GetBirthDate() == b.GetBirthDate()
+            && PersonRole<Row>::Get(a) == PersonRole<Row>::Get(b);
+    }
+
+    static void writeFile(const std::string& path, const std::string& text) {
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        file << text;
+        if (!file) throw std::runtime_error("Cannot write " + path);
+    }
+
+    // Names with quotes, spaces and the delimiter, now and then far longer than the
+    // loader's buffer. Comma files get no tabs, since a tab anywhere on the first line
+    // selects the tab delimiter.
+    static std::string randomText(std::mt19937& gen, char delimiter) {
+        static const char letters[] = "abcXYZ \"',;\t";
+        int length = gen() % 16 ? static_cast<int>(gen() % 12) : static_cast<int>(gen() % 400);
+        int alphabet = delimiter == '\t' ? sizeof(letters) - 1 : sizeof(letters) - 2;
+
+        std::string text;
+        for (int i = 0; i < length; ++i) text.push_back(letters[gen() % alphabet]);
+        return text;
+    }
+
+    // Quotes field when it has to be, and at random otherwise.
+    static std::string encodeField(std::mt19937& gen, const std::string& field, char delimiter) {
+        bool quote = field.find_first_of(std::string("\"") + delimiter) != std::string::npos || gen() % 4 == 0;
+        if (!quote) return field;
+
+        std::string encoded = "\"";
+        for (char c : field) {
+            if (c == '"') encoded.push_back('"');
+            encoded.push_back(c);
+        }
+        return encoded + "\"";
+    }
+
+    // Writes random rows with random quoting, delimiter, line endings, header and blank
+    // lines, reads them back with buffers from a single byte up, and compares every field.
+    template <typename Row>
+    void runLoaderRoundTrip(const char* name, const std::string& path, std::mt19937& gen) {
+        using Role = PersonRole<Row>;
+        const int rounds = 40;
+
+        for (int round = 0; round < rounds; ++round) {
+            char delimiter = gen() % 2 ? '\t' : ',';
+            std::string newline = gen() % 2 ? "\r\n" : "\n";
+            std::vector<Row> expected;
+            std::string text;
+
+            if (gen() % 2) {
+                const char* header[] = {"series", "number", "first name", "middle name", "last name", "born", "role"};
+                for (int i = 0; i < (Role::HasField ? 7 : 6); ++i) {
+                    text += (i ? std::string(1, delimiter) : std::string()) + encodeField(gen, header[i], delimiter);
+                }
+                text += newline;
+            }
+
+            int count = static_cast<int>(gen() % 64);
+            for (int i = 0; i < count; ++i) {
+                if (gen() % 8 == 0) text += newline;
+
+                PersonID id = PersonID::FromPacked(gen() % 10000000000ULL);
+                std::string firstName = randomText(gen, delimiter);
+                std::string middleName = randomText(gen, delimiter);
+                std::string lastName = randomText(gen, delimiter);
+                std::string role = Role::HasField ? randomText(gen, delimiter) : std::string();
+
+                std::string born;
+                time_t birthDate = 0;
+                switch (gen() % 3) {
+                    case 0:
+                        break;
+                    case 1:
+                        birthDate = static_cast<time_t>(gen() % 2000000000);
+                        born = std::to_string(birthDate);
+                        break;
+                    default: {
+                        std::tm tm = {};
+                        tm.tm_year = 60 + static_cast<int>(gen() % 60);
+                        tm.tm_mon = static_cast<int>(gen() % 12);
+                        tm.tm_mday = 1 + static_cast<int>(gen() % 28);
+                        tm.tm_isdst = -1;
+                        char date[16];
+                        std::snprintf(date, sizeof(date), "%04d-%02d-%02d", tm.tm_year + 1900, tm.tm_mon + 1, tm.tm_mday);
+                        born = date;
+                        birthDate = std::mktime(&tm);
+                    }
+                }
+
+                std::string fields[] = {id.GetSeries(), id.GetNumber(), firstName, middleName, lastName, born, role};
+                for (int f = 0; f < (Role::HasField ? 7 : 6); ++f) {
+                    text += (f ? std::string(1, delimiter) : std::string()) + encodeField(gen, fields[f], delimiter);
+                }
+                if (i + 1 < count || gen() % 2) text += newline;
+
+                expected.push_back(Role::Make(id, firstName, middleName, lastName, birthDate, role));
+            }
+            writeFile(path, text);
+
+            std::size_t bufferSize = gen() % 3 ? 1 + gen() % 32 : 1 << 20;
+            PersonLoader<Row> loader(path, bufferSize);
+            std::vector<Row> rows;
+            long long loaded = loader.ForEach([&](const Row& row) {
+                rows.push_back(row);
+            });
+
+            bool same = loaded == count && static_cast<int>(rows.size()) == count;
+            for (int i = 0; i < count && same; ++i) {
+                same = sameRow(rows[i], expected[i]);
+            }
+            check(same, "rows read back with a " + std::to_string(bufferSize) + " byte buffer", name, round);
+        }
+
+        // The bulk paths see the same rows as ForEach.
+        Set<Row> set;
+        PersonStore<Row> store;
+        MutableListSequence<Row> list;
+        long long loaded = PersonLoader<Row>(path).ForEach([](const Row&) {});
+        check(PersonLoader<Row>(path).LoadInto(set) == loaded && PersonLoader<Row>(path).LoadInto(store) == loaded
+              && PersonLoader<Row>(path).LoadInto(list) == loaded && list.GetLength() == loaded
+              && store.GetSize() == set.size(), "LoadInto", name, rounds);
+    }
+
+    // Reads text as a Student file and expects a std::runtime_error naming line.
+    static void checkLoaderError(const std::string& path, const std::string& text, int line, const char* what) {
+        writeFile(path, text);
+        std::string message;
+        try {
+            PersonLoader<Student>(path, 8).ForEach([](const Student&) {});
+        } catch (const std::runtime_error& error) {
+            message = error.what();
+        }
+        std::string prefix = path + ":" + std::to_string(line) + ": ";
+        check(message.compare(0, prefix.size(), prefix) == 0, std::string("error for ") + what, "loader", line);
+    }
+
+    void runLoader() {
+        std::mt19937 gen(options.seed);
+        std::string path = (std::filesystem::temp_directory_path()
+            / ("headless_loader_" + std::to_string(options.seed) + ".txt")).string();
+
+        // A quoted series on the first line is a record, not a header; "" is a literal quote.
+        writeFile(path, "\"1234\",567890,\"Ivan \"\"Vanya\"\"\",,\"Ivanov, Jr\",1,S1\r\n"
+                        "1234,567891,Anna,,Popova,,S2");
+        std::vector<Student> rows;
+        PersonLoader<Student>(path, 4).ForEach([&](const Student& student) {
+            rows.push_back(student);
+        });
+        check(rows.size() == 2 && rows[0].GetID() == PersonID("1234", "567890") && rows[0].GetFirstName() == "Ivan \"Vanya\""
+              && rows[0].GetMiddleName().empty() && rows[0].GetLastName() == "Ivanov, Jr" && rows[0].GetBirthDate() == 1
+              && rows[0].GetStudentId() == "S1" && rows[1].GetStudentId() == "S2", "quoted first record", "loader", 2);
+
+        // A header is skipped, and a tab file keeps its commas.
+        writeFile(path, "\"series\"\tnumber\tfirst\tmiddle\tlast\tborn\tdepartment\n"
+                        "0001\t000002\tAnna, Maria\t\tPopova\t\tPhysics, Applied\n");
+        std::vector<Teacher> teachers;
+        PersonLoader<Teacher>(path).ForEach([&](const Teacher& teacher) {
+            teachers.push_back(teacher);
+        });
+        check(teachers.size() == 1 && teachers[0].GetFirstName() == "Anna, Maria"
+              && teachers[0].GetDepartment() == "Physics, Applied", "tab file with a header", "loader", 1);
+
+        const std::string good = "1234,567890,Ivan,Ivanovich,Ivanov,2001-02-03,S1\n";
+        checkLoaderError(path, "1234,567890,Ivan,Ivanovich,Ivanov,2001-02-30,S1\n", 1, "a day past the month's end");
+        checkLoaderError(path, "series,number\n" + good + "1234,567891,Ivan,Ivanovich,Ivanov,2001-13-01,S1\n", 3,
+                         "month 13");
+        checkLoaderError(path, good + "1234,567891,Ivan,Ivanovich,Ivanov,2001-2-03,S1\r\n", 2, "a malformed date");
+        checkLoaderError(path, good + good + "1234,567891,Ivan,Ivanov,2001-02-03,S1\n", 3, "a missing field");
+        checkLoaderError(path, good + "1234,567891,\"Ivan,Ivanovich,Ivanov,2001-02-03,S1\n", 2, "an open quote");
+        checkLoaderError(path, good + "1234,567891,\"Ivan\"x,Ivanovich,Ivanov,2001-02-03,S1\n", 2,
+                         "text after a quote");
+        checkLoaderError(path, good + "12a4,567891,Ivan,Ivanovich,Ivanov,2001-02-03,S1\n", 2, "a bad series");
+
+        runLoaderRoundTrip<Person>("loader Person", path, gen);
+        runLoaderRoundTrip<Student>("loader Student", path, gen);
+        runLoaderRoundTrip<Teacher>("loader Teacher", path, gen);
+        std::filesystem::remove(path);
+
+        std::cout << "loader: fixed cases and round trips passed\n";
+    }
+
+public:
+    explicit HeadlessTester(const HeadlessTestOptions& options_) : options(options_) {}
+
+    void runAll() {
+        auto wants = [&](const char* name) {
+            return std::find(options.types.begin(), options.types.end(), name) != options.types.end();
+        };
+        if (wants("int")) runType<int>();
+        if (wants("double")) runType<double>();
+        if (wants("string")) runType<std::string>();
+        if (wants("student")) runType<Student>();
+        if (wants("teacher")) runType<Teacher>();
+
+        auto wantsSequence = [&](const char* name) {
+            return std::find(options.sequences.begin(), options.sequences.end(), name) != options.sequences.end();
+        };
+        auto none = [](std::mt19937&, Model&, long long) {};
+        if (wantsSequence("dynamic")) runDynamicArray();
+        if (wantsSequence("array")) {
+            MutableArraySequence<int> sequence;
+            runSequence("array", sequence, none);
+        }
+        if (wantsSequence("list")) {
+            MutableListSequence<int> sequence;
+            runSequence("list", sequence, none);
+        }
+        if (wantsSequence("segmented")) runSegmented<MutableArraySequence>("segmented");
+        if (wantsSequence("segmented-list")) runSegmented<MutableListSequence>("segmented-list");
+        if (wantsSequence("rope")) runRope();
+        if (wantsSequence("persistent")) runPersistent<ImmutableArraySequence<int>>("persistent");
+        if (wantsSequence("persistent-unrolled")) runPersistent<ImmutableUnrolledListSequence<int>>("persistent-unrolled");
+        if (wantsSequence("unrolled")) {
+            MutableUnrolledListSequence<int> sequence;
+            runSequence("unrolled", sequence, none);
+        }
+
+        auto wantsCheck = [&](const char* name) {
+            return std::find(options.checks.begin(), options.checks.end(), name) != options.checks.end();
+        };
+        if (wantsCheck("parallel")) runParallel();
+        if (wantsCheck("views")) runViews();
+        if (wantsCheck("store")) {
+            runStore<Student>();
+            runStore<Teacher>();
+        }
+        if (wantsCheck("loader")) runLoader();
+    }
+
+    // Entry point for a test executable; returns the process exit code.
+    static int run(int argc, char** argv) {
+        try {
+            HeadlessTestOptions options = HeadlessTestOptions::parse(argc, argv);
+            HeadlessTester(options).runAll();
+            std::cout << "All headless tests PASSED!\n";
+            return 0;
+        } catch (const std::exception& e) {
+            std::cerr << "Headless tests FAILED: " << e.what() << "\n";
+            return 1;
+        }
+    }
+};
@@ -1,24 +1,84 @@
 #pragma once
 #include <string>
+#include <string_view>
+#include <cstddef>
+#include <cstdint>
 #include <ctime>
+#include <functional>
+#include <stdexcept>
 #include <iostream>
 #include <iomanip>
+#include "StringPool.hpp"
 
+// Passport-style ID: a 4-digit series and a 6-digit number packed into one integer,
+// series * 10^6 + number. Integer order matches the order of the fixed-width digit
+// strings, so comparisons and hashing never touch text.
 class PersonID {
 private:
-    std::string series;
-    std::string number;
+    static constexpr int SeriesDigits = 4;
+    static constexpr int NumberDigits = 6;
+    static constexpr std::uint64_t NumberRange = 1000000;
+    static constexpr std::uint64_t PackedRange = 10000 * NumberRange;
+
+    std::uint64_t packed;
+
+    static std::uint64_t parseDigits(std::string_view text, int digits, const char* field) {
+        if (static_cast<int>(text.size()) != digits) {
+            throw std::invalid_argument(std::string(field) + " must have exactly " + std::to_string(digits) + " digits");
+        }
+
+        std::uint64_t value = 0;
+        for (char c : text) {
+            if (c < '0' || c > '9') {
+                throw std::invalid_argument(std::string(field) + " must contain only digits");
+            }
+            value = value * 10 + static_cast<std::uint64_t>(c - '0');
+        }
+        return value;
+    }
+
+    static void formatDigits(std::uint64_t value, int digits, char* out) {
+        for (int i = digits - 1; i >= 0; --i) {
+            out[i] = static_cast<char>('0' + value % 10);
+            value /= 10;
+        }
+    }
 
 public:
-    PersonID() : series("0000"), number("000000") {}
-    PersonID(const std::string& series, const std::string& number)
-        : series(series), number(number) {}
+    PersonID() : packed(0) {}
+    PersonID(std::string_view series, std::string_view number)
+        : packed(parseDigits(series, SeriesDigits, "PersonID series") * NumberRange +
+                 parseDigits(number, NumberDigits, "PersonID number")) {}
+
+    static PersonID FromPacked(std::uint64_t value) {
+        if (value >= PackedRange) {
+            throw std::out_of_range("Packed PersonID out of range");
+        }
+
+        PersonID id;
+        id.packed = value;
+        return id;
+    }
+
+    std::uint64_t GetPacked() const { return packed; }
 
-    std::string GetSeries() const { return series; }
-    std::string GetNumber() const { return number; }
+    std::string GetSeries() const {
+        std::string series(SeriesDigits, '0');
+        formatDigits(packed / NumberRange, SeriesDigits, &series[0]);
+        return series;
+    }
+
+    std::string GetNumber() const {
+        std::string number(NumberDigits, '0');
+        formatDigits(packed % NumberRange, NumberDigits, &number[0]);
+        return number;
+    }
 
     std::string ToString() const {
-        return series + " " + number;
+        std::string text(SeriesDigits + 1 + NumberDigits, ' ');
+        formatDigits(packed / NumberRange, SeriesDigits, &text[0]);
+        formatDigits(packed % NumberRange, NumberDigits, &text[SeriesDigits + 1]);
+        return text;
     }
 
     friend std::ostream& operator<<(std::ostream& os, const PersonID& id) {
@@ -27,43 +87,93 @@ public:
     }
 
     bool operator==(const PersonID& other) const {
-        return series == other.series && number == other.number;
+        return packed == other.packed;
     }
 
     bool operator!=(const PersonID& other) const {
-        return !(*this == other);
+        return packed != other.packed;
     }
 
     bool operator<(const PersonID& other) const {
-        if (series != other.series) return series < other.series;
-        return number < other.number;
+        return packed < other.packed;
+    }
+
+    bool operator>(const PersonID& other) const {
+        return packed > other.packed;
+    }
+
+    bool operator<=(const PersonID& other) const {
+        return packed <= other.packed;
+    }
+
+    bool operator>=(const PersonID& other) const {
+        return packed >= other.packed;
+    }
+
+    int Compare(const PersonID& other) const {
+        return (packed > other.packed) - (packed < other.packed);
+    }
+
+    // splitmix64 finaliser, so neighbouring IDs land in unrelated buckets.
+    std::size_t Hash() const {
+        std::uint64_t x = packed + 0x9E3779B97F4A7C15ULL;
+        x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+        return static_cast<std::size_t>(x ^ (x >> 31));
     }
 };
 
+namespace std {
+    template <>
+    struct hash<PersonID> {
+        size_t operator()(const PersonID& id) const {
+            return id.Hash();
+        }
+    };
+}
+
 class Person {
 protected:
     PersonID id;
-    std::string firstName;
-    std::string middleName;
-    std::string lastName;
+    InternedString firstName;
+    InternedString middleName;
+    InternedString lastName;
     time_t birthDate;
 
+    // The packed ID in the high 34 bits and the first 30 bits of lastName below it.
+    // Comparing keys agrees with operator< whenever the keys differ, so only records
+    // with the same ID and last-name prefix need the full field-by-field comparison.
+    std::uint64_t sortKey;
+
+    static std::uint64_t makeSortKey(const PersonID& id, const std::string& lastName) {
+        std::uint64_t prefix = 0;
+        for (int i = 0; i < 4; ++i) {
+            unsigned char c = i < static_cast<int>(lastName.size()) ? static_cast<unsigned char>(lastName[i]) : 0;
+            prefix = (prefix << 8) | c;
+        }
+        return (id.GetPacked() << 30) | (prefix >> 2);
+    }
+
 public:
-    Person() : id(), firstName(""), middleName(""), lastName(""), birthDate(0) {}
+    Person() : id(), firstName(), middleName(), lastName(), birthDate(0), sortKey(0) {}
     Person(const PersonID& id, const std::string& firstName, 
            const std::string& middleName, const std::string& lastName, 
            time_t birthDate)
         : id(id), firstName(firstName), middleName(middleName), 
-          lastName(lastName), birthDate(birthDate) {}
+          lastName(lastName), birthDate(birthDate), sortKey(makeSortKey(id, lastName)) {}
 
     const PersonID& GetID() const { return id; }
-    std::string GetFirstName() const { return firstName; }
-    std::string GetMiddleName() const { return middleName; }
-    std::string GetLastName() const { return lastName; }
+    const std::string& GetFirstName() const { return firstName.Get(); }
+    const std::string& GetMiddleName() const { return middleName.Get(); }
+    const std::string& GetLastName() const { return lastName.Get(); }
     std::string GetFullName() const { 
-        return firstName + " " + middleName + " " + lastName; 
+        std::string fullName;
+        fullName.reserve(GetFirstName().size() + GetMiddleName().size() + GetLastName().size() + 2);
+        fullName.append(GetFirstName()).append(" ").append(GetMiddleName()).append(" ").append(GetLastName());
+        return fullName;
     }
     time_t GetBirthDate() const { return birthDate; }
+    std::uint64_t GetSortKey() const { return sortKey; }
 
     friend std::ostream& operator<<(std::ostream& os, const Person& person) {
         std::tm tm = {};
@@ -79,34 +189,41 @@ public:
     }
 
     bool operator==(const Person& other) const {
-    return id.GetSeries() == other.id.GetSeries() &&
-            id.GetNumber() == other.id.GetNumber() &&
+    return id == other.id &&
             firstName == other.firstName &&
             lastName == other.lastName &&
             birthDate == other.birthDate;
     }
 
+    // Orders by ID, last name, first name and birth date in one pass; negative, zero or
+    // positive like std::string::compare.
+    int Compare(const Person& other) const {
+        if (sortKey != other.sortKey) return sortKey < other.sortKey ? -1 : 1;
+        if (int order = lastName.Compare(other.lastName)) return order;
+        if (int order = firstName.Compare(other.firstName)) return order;
+        return (birthDate > other.birthDate) - (birthDate < other.birthDate);
+    }
+
     bool operator<(const Person& other) const {
-        if (id != other.id) return id < other.id;
-        if (lastName != other.lastName) return lastName < other.lastName;
-        if (firstName != other.firstName) return firstName < other.firstName;
-        return birthDate < other.birthDate;
+        return Compare(other) < 0;
     }
 };
 
 class Student : public Person {
 private:
+    // Owned rather than interned: IDs are unique per student, so pooling them would only
+    // grow the never-freed pool by one entry per student.
     std::string studentId;
 
 public:
-    Student() : Person(), studentId("") {}
+    Student() : Person(), studentId() {}
     Student(const PersonID& id, const std::string& firstName, 
             const std::string& middleName, const std::string& lastName, 
             time_t birthDate, const std::string& studentId)
         : Person(id, firstName, middleName, lastName, birthDate), 
           studentId(studentId) {}
 
-    std::string GetStudentId() const { return studentId; }
+    const std::string& GetStudentId() const { return studentId; }
 
     friend std::ostream& operator<<(std::ostream& os, const Student& student) {
         os << static_cast<const Person&>(student) 
@@ -118,9 +235,13 @@ public:
                studentId == other.studentId;
     }
 
+    int Compare(const Student& other) const {
+        if (int order = Person::Compare(other)) return order;
+        return studentId.compare(other.studentId);
+    }
+
     bool operator<(const Student& other) const {
-        if (!Person::operator==(other)) return Person::operator<(other);
-        return studentId < other.studentId;
+        return Compare(other) < 0;
     }
 
     friend std::istream& operator>>(std::istream& is, Student& student) {
@@ -135,24 +256,41 @@ public:
         std::cout << "Last Name: "; is >> lastName;
         std::cout << "Student ID: "; is >> studentId;
 
-        student = Student(PersonID(series, number), firstName, middleName, lastName, birthDate, studentId);
+        if (!is) return is;
+
+        // A malformed ID fails the stream like any other bad token and leaves student unchanged.
+        try {
+            student = Student(PersonID(series, number), firstName, middleName, lastName, birthDate, studentId);
+        } catch (const std::invalid_argument&) {
+            is.setstate(std::ios::failbit);
+        }
         return is;
     }
 };
 
+// The student ID is the only field a Student owns on the heap; names are pooled.
+template <>
+struct OwnedHeap<Student> {
+    static constexpr bool Tracked = true;
+
+    static std::size_t Bytes(const Student& student) {
+        return OwnedHeap<std::string>::Bytes(student.GetStudentId());
+    }
+};
+
 class Teacher : public Person {
 private:
-    std::string department;
+    InternedString department;
 
 public:
-    Teacher() : Person(), department("") {}
+    Teacher() : Person(), department() {}
     Teacher(const PersonID& id, const std::string& firstName, 
             const std::string& middleName, const std::string& lastName, 
             time_t birthDate, const std::string& department)
         : Person(id, firstName, middleName, lastName, birthDate), 
           department(department) {}
 
-    std::string GetDepartment() const { return department; }
+    const std::string& GetDepartment() const { return department.Get(); }
 
     friend std::ostream& operator<<(std::ostream& os, const Teacher& teacher) {
         os << static_cast<const Person&>(teacher) 
@@ -165,9 +303,13 @@ public:
                department == other.department;
     }
 
+    int Compare(const Teacher& other) const {
+        if (int order = Person::Compare(other)) return order;
+        return department.Compare(other.department);
+    }
+
     bool operator<(const Teacher& other) const {
-        if (!Person::operator==(other)) return Person::operator<(other);
-        return department < other.department;
+        return Compare(other) < 0;
     }
 
     friend std::istream& operator>>(std::istream& is, Teacher& teacher) {
@@ -182,7 +324,14 @@ public:
         std::cout << "Last Name: "; is >> lastName;
         std::cout << "Department: "; is >> department;
 
-        teacher = Teacher(PersonID(series, number), firstName, middleName, lastName, birthDate, department);
+        if (!is) return is;
+
+        // A malformed ID fails the stream like any other bad token and leaves teacher unchanged.
+        try {
+            teacher = Teacher(PersonID(series, number), firstName, middleName, lastName, birthDate, department);
+        } catch (const std::invalid_argument&) {
+            is.setstate(std::ios::failbit);
+        }
         return is;
     }
 };
\ No newline at end of file
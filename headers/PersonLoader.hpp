@@ -0,0 +1,270 @@
+#pragma once
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include "Person.hpp"
+#include "PersonStore.hpp"
+#include "Set.hpp"
+
+
+// Non-interactive reader for delimited person files, one record per line:
+//
+//     series, number, first name, middle name, last name, birth date[, role field]
+//
+// The role field (student ID or department) is present for Student and Teacher rows.
+// Birth dates are YYYY-MM-DD in local time, as printed by operator<<, or a plain
+// number of seconds; an empty date is 0. The delimiter is a tab if the first line
+// contains one and a comma otherwise. A first line whose series is not numeric is
+// taken as a header. Fields may be wrapped in double quotes, with "" for a literal
+// quote, but may not span lines.
+//
+// The file is read in large blocks and split in place, without iostreams.
+template <typename Row>
+class PersonLoader {
+private:
+    using Role = PersonRole<Row>;
+    static constexpr int FieldCount = Role::HasField ? 7 : 6;
+
+    std::FILE* file;
+    std::string path;
+    std::unique_ptr<char[]> buffer;
+    std::size_t bufferSize;
+
+    char delimiter;
+    long long lineNumber;
+    std::string fields[FieldCount];
+    std::unordered_map<int, time_t> dateCache;
+
+    [[noreturn]] void fail(const std::string& message) const {
+        throw std::runtime_error(path + ":" + std::to_string(lineNumber) + ": " + message);
+    }
+
+    // Splits line into fields, unquoting where needed. Returns false for blank lines.
+    // With a smaller limit only the first limit fields are read and the rest of the line
+    // is ignored, so any line can be inspected without failing on its field count.
+    bool splitLine(const char* begin, const char* end, int limit = FieldCount) {
+        if (end > begin && end[-1] == '\r') --end;
+        if (begin == end) return false;
+
+        int count = 0;
+        const char* cursor = begin;
+        while (true) {
+            if (count == limit) {
+                if (limit < FieldCount) return true;
+                fail("expected " + std::to_string(FieldCount) + " fields");
+            }
+            std::string& field = fields[count++];
+
+            if (cursor < end && *cursor == '"') {
+                field.clear();
+                ++cursor;
+                while (true) {
+                    const char* quote = static_cast<const char*>(std::memchr(cursor, '"', end - cursor));
+                    if (!quote) fail("unterminated quoted field");
+
+                    field.append(cursor, quote);
+                    cursor = quote + 1;
+                    if (cursor < end && *cursor == '"') {
+                        field.push_back('"');
+                        ++cursor;
+                    } else {
+                        break;
+                    }
+                }
+                if (cursor < end && *cursor != delimiter) fail("unexpected text after quoted field");
+            } else {
+                const char* stop = static_cast<const char*>(std::memchr(cursor, delimiter, end - cursor));
+                if (!stop) stop = end;
+                field.assign(cursor, stop);
+                cursor = stop;
+            }
+
+            if (cursor == end) break;
+            ++cursor;
+        }
+
+        if (limit == FieldCount && count != FieldCount) {
+            fail("expected " + std::to_string(FieldCount) + " fields, found " + std::to_string(count));
+        }
+        return true;
+    }
+
+    static bool isNumber(std::string_view text) {
+        if (text.empty()) return false;
+        for (char c : text) {
+            if (c < '0' || c > '9') return false;
+        }
+        return true;
+    }
+
+    static int parseNumber(const char* digits, int count) {
+        int value = 0;
+        for (int i = 0; i < count; ++i) {
+            if (digits[i] < '0' || digits[i] > '9') return -1;
+            value = value * 10 + (digits[i] - '0');
+        }
+        return value;
+    }
+
+    // mktime is slow, but rosters repeat a few thousand distinct dates, so each is
+    // converted once.
+    time_t parseDate(const std::string& text) {
+        if (text.empty()) return 0;
+        if (isNumber(text)) {
+            try {
+                return static_cast<time_t>(std::stoll(text));
+            } catch (const std::out_of_range&) {
+                fail("invalid birth date '" + text + "'");
+            }
+        }
+
+        int year = -1, month = -1, day = -1;
+        if (text.size() == 10 && text[4] == '-' && text[7] == '-') {
+            year = parseNumber(text.data(), 4);
+            month = parseNumber(text.data() + 5, 2);
+            day = parseNumber(text.data() + 8, 2);
+        }
+        if (year < 0 || month < 1 || month > 12 || day < 1 || day > 31) {
+            fail("invalid birth date '" + text + "'");
+        }
+
+        int key = year * 10000 + month * 100 + day;
+        auto cached = dateCache.find(key);
+        if (cached != dateCache.end()) return cached->second;
+
+        std::tm tm = {};
+        tm.tm_year = year - 1900;
+        tm.tm_mon = month - 1;
+        tm.tm_mday = day;
+        tm.tm_isdst = -1;
+        time_t date = std::mktime(&tm);
+        // mktime normalises out-of-range days (2001-02-30 becomes March 2nd), so a changed
+        // day or month means the date does not exist.
+        if (date == static_cast<time_t>(-1) || tm.tm_mday != day || tm.tm_mon != month - 1) {
+            fail("invalid birth date '" + text + "'");
+        }
+        dateCache.emplace(key, date);
+        return date;
+    }
+
+    template <typename Sink>
+    void emitRow(Sink& sink) {
+        try {
+            sink(Role::Make(PersonID(fields[0], fields[1]), fields[2], fields[3], fields[4],
+                            parseDate(fields[5]), Role::HasField ? fields[FieldCount - 1] : std::string()));
+        } catch (const std::logic_error& error) {
+            // PersonID throws invalid_argument; any other logic_error from a field is
+            // reported against the line as well.
+            fail(error.what());
+        }
+    }
+
+public:
+    explicit PersonLoader(const std::string& path_, std::size_t bufferSize_ = 1 << 20) :
+        file(std::fopen(path_.c_str(), "rb")),
+        path(path_),
+        buffer(new char[bufferSize_]),
+        bufferSize(bufferSize_),
+        delimiter(0),
+        lineNumber(0) {
+        if (!file) {
+            throw std::runtime_error("Cannot open " + path_);
+        }
+    }
+
+    PersonLoader(const PersonLoader&) = delete;
+    PersonLoader& operator=(const PersonLoader&) = delete;
+
+    ~PersonLoader() {
+        std::fclose(file);
+    }
+
+    // Parses the rest of the file, calling sink(row) for every record, and returns the
+    // number of records. Malformed lines throw std::runtime_error naming the line.
+    template <typename Sink>
+    long long ForEach(Sink sink) {
+        long long rows = 0;
+        std::size_t begin = 0;
+        std::size_t end = 0;
+        bool eof = false;
+
+        while (true) {
+            char* lineEnd = static_cast<char*>(std::memchr(buffer.get() + begin, '\n', end - begin));
+
+            if (!lineEnd) {
+                if (eof) {
+                    if (begin == end) break;
+                    lineEnd = buffer.get() + end;
+                } else {
+                    // Keep the partial line, growing the buffer if it is longer than the buffer.
+                    std::memmove(buffer.get(), buffer.get() + begin, end - begin);
+                    end -= begin;
+                    begin = 0;
+                    if (end == bufferSize) {
+                        std::unique_ptr<char[]> larger(new char[bufferSize * 2]);
+                        std::memcpy(larger.get(), buffer.get(), end);
+                        buffer = std::move(larger);
+                        bufferSize *= 2;
+                    }
+
+                    std::size_t read = std::fread(buffer.get() + end, 1, bufferSize - end, file);
+                    end += read;
+                    eof = read == 0;
+                    continue;
+                }
+            }
+
+            const char* line = buffer.get() + begin;
+            begin = lineEnd - buffer.get() + (lineEnd < buffer.get() + end ? 1 : 0);
+            ++lineNumber;
+
+            if (delimiter == 0 && line != lineEnd && *line != '\r') {
+                delimiter = std::memchr(line, '\t', lineEnd - line) ? '\t' : ',';
+
+                // The series is judged after unquoting, so "1234" still starts a record.
+                splitLine(line, lineEnd, 1);
+                if (!isNumber(fields[0])) continue;
+            }
+
+            if (splitLine(line, lineEnd)) {
+                emitRow(sink);
+                ++rows;
+            }
+        }
+        return rows;
+    }
+
+    // Bulk-loads the file into a set: rows are collected first and inserted in one
+    // sorted pass.
+    long long LoadInto(Set<Row>& set) {
+        DynamicArray<Row> rows;
+        long long count = ForEach([&](const Row& row) {
+            rows.EmplaceBack(row);
+        });
+        set.insertBulk(rows.GetData(), rows.GetSize());
+        return count;
+    }
+
+    // Appends to a mutable sequence in place.
+    template <typename Target>
+    long long LoadInto(Target& sequence) {
+        static_assert(std::is_base_of_v<MutableSequenceTag, typename Target::tag>,
+            "LoadInto requires a mutable sequence type");
+
+        return ForEach([&](const Row& row) {
+            sequence.Append(row);
+        });
+    }
+
+    long long LoadInto(PersonStore<Row>& store) {
+        return ForEach([&](const Row& row) {
+            store.Insert(row);
+        });
+    }
+};
@@ -0,0 +1,329 @@
+#pragma once
+#include <ctime>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include "AVLTree.hpp"
+#include "Person.hpp"
+
+
+// Role-specific column of a person type: the student ID of a Student, the department
+// of a Teacher. Plain Person rows have none. Field is how the column stores it:
+// departments repeat and are interned, student IDs are unique and kept as plain strings.
+template <typename Row>
+struct PersonRole {
+    static constexpr bool HasField = false;
+    using Field = InternedString;
+
+    static std::string Get(const Row&) { return std::string(); }
+
+    static Row Make(const PersonID& id, const std::string& firstName, const std::string& middleName,
+                    const std::string& lastName, time_t birthDate, const std::string&) {
+        return Row(id, firstName, middleName, lastName, birthDate);
+    }
+};
+
+template <>
+struct PersonRole<Student> {
+    static constexpr bool HasField = true;
+    using Field = std::string;
+
+    static const std::string& Get(const Student& student) { return student.GetStudentId(); }
+
+    static Student Make(const PersonID& id, const std::string& firstName, const std::string& middleName,
+                        const std::string& lastName, time_t birthDate, const std::string& studentId) {
+        return Student(id, firstName, middleName, lastName, birthDate, studentId);
+    }
+};
+
+template <>
+struct PersonRole<Teacher> {
+    static constexpr bool HasField = true;
+    using Field = InternedString;
+
+    static const std::string& Get(const Teacher& teacher) { return teacher.GetDepartment(); }
+
+    static Teacher Make(const PersonID& id, const std::string& firstName, const std::string& middleName,
+                        const std::string& lastName, time_t birthDate, const std::string& department) {
+        return Teacher(id, firstName, middleName, lastName, birthDate, department);
+    }
+};
+
+
+enum class PersonIndex {
+    LastName,
+    Role,
+    BirthDate
+};
+
+
+// Column-wise store of Person rows keyed by PersonID. Each field lives in its own
+// array, so a scan over one field touches only that column. The ID index is always
+// kept; indexes on last name, role field and birth date are built on demand with
+// EnableIndex and then maintained by Insert and Remove.
+// Row numbers are dense: Remove moves the last row into the freed slot.
+template <typename Row>
+class PersonStore {
+private:
+    static_assert(std::is_base_of_v<Person, Row>, "PersonStore rows must derive from Person");
+
+    using Role = PersonRole<Row>;
+    using Field = typename Role::Field;
+    template <typename Key>
+    using Index = AVLTree<std::pair<Key, int>>;
+
+    static constexpr int FirstRow = std::numeric_limits<int>::min();
+    static constexpr int LastRow = std::numeric_limits<int>::max();
+
+    DynamicArray<PersonID> ids;
+    DynamicArray<InternedString> firstNames;
+    DynamicArray<InternedString> middleNames;
+    DynamicArray<InternedString> lastNames;
+    DynamicArray<time_t> birthDates;
+    DynamicArray<Field> roles;
+
+    Index<PersonID> idIndex;
+    Index<InternedString> lastNameIndex;
+    Index<Field> roleIndex;
+    Index<time_t> birthDateIndex;
+    bool lastNameIndexed;
+    bool roleIndexed;
+    bool birthDateIndexed;
+
+    template <typename Key>
+    static int findRow(const Index<Key>& index, const Key& key) {
+        int row = -1;
+        index.forEachInRange({key, FirstRow}, {key, LastRow}, [&](const std::pair<Key, int>& entry) {
+            row = entry.second;
+        });
+        return row;
+    }
+
+    template <typename Key>
+    static MutableArraySequence<int> findRows(const Index<Key>& index, const Key& low, const Key& high) {
+        MutableArraySequence<int> rows;
+        index.forEachInRange({low, FirstRow}, {high, LastRow}, [&](const std::pair<Key, int>& entry) {
+            rows.Append(entry.second);
+        });
+        return rows;
+    }
+
+    template <typename Key, typename Predicate>
+    static MutableArraySequence<int> scanRows(const DynamicArray<Key>& column, Predicate matches) {
+        MutableArraySequence<int> rows;
+        const Key* values = column.GetData();
+        for (int row = 0; row < column.GetSize(); ++row) {
+            if (matches(values[row])) {
+                rows.Append(row);
+            }
+        }
+        return rows;
+    }
+
+    static const std::string& text(const InternedString& value) {
+        return value.Get();
+    }
+
+    static const std::string& text(const std::string& value) {
+        return value;
+    }
+
+    // Query keys are looked up, never interned: a text absent from the pool matches no row.
+    static bool findKey(const std::string& value, InternedString& key) {
+        return InternedString::Find(value, key);
+    }
+
+    static bool findKey(const std::string& value, std::string& key) {
+        key = value;
+        return true;
+    }
+
+    template <typename Key>
+    static void buildIndex(Index<Key>& index, const DynamicArray<Key>& column) {
+        DynamicArray<std::pair<Key, int>> entries;
+        entries.Reserve(column.GetSize());
+        for (int row = 0; row < column.GetSize(); ++row) {
+            entries.EmplaceBack(column.GetData()[row], row);
+        }
+
+        index.clear();
+        index.insertBulk(entries.GetData(), entries.GetSize());
+    }
+
+    void indexRow(int row) {
+        idIndex.insert({ids[row], row});
+        if (lastNameIndexed) lastNameIndex.insert({lastNames[row], row});
+        if (roleIndexed) roleIndex.insert({roles[row], row});
+        if (birthDateIndexed) birthDateIndex.insert({birthDates[row], row});
+    }
+
+    void unindexRow(int row) {
+        idIndex.remove({ids[row], row});
+        if (lastNameIndexed) lastNameIndex.remove({lastNames[row], row});
+        if (roleIndexed) roleIndex.remove({roles[row], row});
+        if (birthDateIndexed) birthDateIndex.remove({birthDates[row], row});
+    }
+
+    void checkRow(int row) const {
+        if (row < 0 || row >= ids.GetSize()) {
+            throw std::out_of_range("Row index out of range");
+        }
+    }
+
+public:
+    PersonStore() : lastNameIndexed(false), roleIndexed(false), birthDateIndexed(false) {}
+
+    int GetSize() const {
+        return ids.GetSize();
+    }
+
+    void Reserve(int capacity) {
+        ids.Reserve(capacity);
+        firstNames.Reserve(capacity);
+        middleNames.Reserve(capacity);
+        lastNames.Reserve(capacity);
+        birthDates.Reserve(capacity);
+        roles.Reserve(capacity);
+    }
+
+    void EnableIndex(PersonIndex kind) {
+        switch (kind) {
+            case PersonIndex::LastName:
+                if (!lastNameIndexed) buildIndex(lastNameIndex, lastNames);
+                lastNameIndexed = true;
+                break;
+            case PersonIndex::Role:
+                if (!roleIndexed) buildIndex(roleIndex, roles);
+                roleIndexed = true;
+                break;
+            case PersonIndex::BirthDate:
+                if (!birthDateIndexed) buildIndex(birthDateIndex, birthDates);
+                birthDateIndexed = true;
+                break;
+        }
+    }
+
+    void DisableIndex(PersonIndex kind) {
+        switch (kind) {
+            case PersonIndex::LastName:
+                lastNameIndex.clear();
+                lastNameIndexed = false;
+                break;
+            case PersonIndex::Role:
+                roleIndex.clear();
+                roleIndexed = false;
+                break;
+            case PersonIndex::BirthDate:
+                birthDateIndex.clear();
+                birthDateIndexed = false;
+                break;
+        }
+    }
+
+    // Adds person unless a row with the same ID is already stored.
+    bool Insert(const Row& person) {
+        if (Contains(person.GetID())) return false;
+
+        ids.EmplaceBack(person.GetID());
+        firstNames.EmplaceBack(person.GetFirstName());
+        middleNames.EmplaceBack(person.GetMiddleName());
+        lastNames.EmplaceBack(person.GetLastName());
+        birthDates.EmplaceBack(person.GetBirthDate());
+        roles.EmplaceBack(Role::Get(person));
+
+        indexRow(ids.GetSize() - 1);
+        return true;
+    }
+
+    template <typename Source>
+    void InsertAll(const Source& source) {
+        source.ForEach([this](const Row& person) {
+            Insert(person);
+        });
+    }
+
+    bool Remove(const PersonID& id) {
+        int row = Find(id);
+        if (row < 0) return false;
+
+        int last = ids.GetSize() - 1;
+        unindexRow(row);
+        if (row != last) {
+            unindexRow(last);
+            ids[row] = ids[last];
+            firstNames[row] = firstNames[last];
+            middleNames[row] = middleNames[last];
+            lastNames[row] = lastNames[last];
+            birthDates[row] = birthDates[last];
+            roles[row] = roles[last];
+            indexRow(row);
+        }
+
+        ids.RemoveAt(last);
+        firstNames.RemoveAt(last);
+        middleNames.RemoveAt(last);
+        lastNames.RemoveAt(last);
+        birthDates.RemoveAt(last);
+        roles.RemoveAt(last);
+        return true;
+    }
+
+    // Row number of id, or -1.
+    int Find(const PersonID& id) const {
+        return findRow(idIndex, id);
+    }
+
+    bool Contains(const PersonID& id) const {
+        return Find(id) >= 0;
+    }
+
+    Row GetRow(int row) const {
+        checkRow(row);
+        return Role::Make(ids.Get(row), firstNames.Get(row).Get(), middleNames.Get(row).Get(),
+                          lastNames.Get(row).Get(), birthDates.Get(row), text(roles.Get(row)));
+    }
+
+    MutableArraySequence<Row> GetRows(const MutableArraySequence<int>& rows) const {
+        MutableArraySequence<Row> result;
+        result.Reserve(rows.GetLength());
+        rows.ForEach([&](int row) {
+            result.Append(GetRow(row));
+        });
+        return result;
+    }
+
+    // Rows are returned in index order when the index is enabled and in storage order
+    // otherwise.
+    MutableArraySequence<int> FindByLastName(const std::string& lastName) const {
+        InternedString key;
+        if (!findKey(lastName, key)) return MutableArraySequence<int>();
+        if (lastNameIndexed) return findRows(lastNameIndex, key, key);
+        return scanRows(lastNames, [&](const InternedString& value) { return value == key; });
+    }
+
+    MutableArraySequence<int> FindByRole(const std::string& value) const {
+        Field key;
+        if (!findKey(value, key)) return MutableArraySequence<int>();
+        if (roleIndexed) return findRows(roleIndex, key, key);
+        return scanRows(roles, [&](const Field& role) { return role == key; });
+    }
+
+    MutableArraySequence<int> FindBornBetween(time_t from, time_t to) const {
+        if (birthDateIndexed) return findRows(birthDateIndex, from, to);
+        return scanRows(birthDates, [&](time_t date) { return from <= date && date <= to; });
+    }
+
+    // ID order, through the primary index.
+    MutableArraySequence<int> FindIDsBetween(const PersonID& from, const PersonID& to) const {
+        return findRows(idIndex, from, to);
+    }
+
+    const DynamicArray<PersonID>& GetIDColumn() const { return ids; }
+    const DynamicArray<InternedString>& GetFirstNameColumn() const { return firstNames; }
+    const DynamicArray<InternedString>& GetMiddleNameColumn() const { return middleNames; }
+    const DynamicArray<InternedString>& GetLastNameColumn() const { return lastNames; }
+    const DynamicArray<time_t>& GetBirthDateColumn() const { return birthDates; }
+    const DynamicArray<Field>& GetRoleColumn() const { return roles; }
+};
@@ -2,11 +2,19 @@
 #include <iostream>
 #include <stdexcept>
 #include <algorithm>
+#include <cstring>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include "MemoryUsage.hpp"
 
 
 template <typename T>
 class DynamicArray {
 private:
+    // Elements live in [data, data + size) inside an allocation of capacity slots
+    // starting at buffer. Room left in front of data makes prepends O(1) amortised.
+    T* buffer;
     T* data;
     int size;
     int capacity;
@@ -26,30 +34,220 @@ private:
         }
     }
 
+    static T* _allocate(int count) {
+        return count ? std::allocator<T>().allocate(count) : nullptr;
+    }
+
+    static void _deallocate(T* ptr, int count) {
+        if (ptr) std::allocator<T>().deallocate(ptr, count);
+    }
+
+    // Element types that can be shifted inside the buffer without any step throwing. Other
+    // types are always moved into a fresh buffer so a failure leaves the array untouched.
+    static constexpr bool _nothrowRelocate =
+        std::is_trivially_copyable_v<T> || std::is_nothrow_move_constructible_v<T>;
+
+    // Moves count elements from `from` to `to`, leaving the source slots destroyed.
+    // The ranges may overlap; destination slots outside the source must be uninitialised.
+    // Only used when _nothrowRelocate holds.
+    static void _relocate(T* from, int count, T* to) {
+        if (count <= 0 || from == to) return;
+
+        if constexpr (std::is_trivially_copyable_v<T>) {
+            std::memmove(static_cast<void*>(to), static_cast<const void*>(from), sizeof(T) * count);
+        } else if (to < from) {
+            for (int i = 0; i < count; ++i) {
+                ::new (static_cast<void*>(to + i)) T(std::move(from[i]));
+                std::destroy_at(from + i);
+            }
+        } else {
+            for (int i = count - 1; i >= 0; --i) {
+                ::new (static_cast<void*>(to + i)) T(std::move(from[i]));
+                std::destroy_at(from + i);
+            }
+        }
+    }
+
+    // Moves (or, when moving may throw, copies) count elements into uninitialised slots
+    // of another buffer. On failure the slots built so far are destroyed again and the
+    // source is left intact.
+    static void _transfer(T* from, int count, T* to) {
+        if (count <= 0) return;
+
+        if constexpr (_nothrowRelocate || !std::is_copy_constructible_v<T>) {
+            std::uninitialized_move(from, from + count, to);
+        } else {
+            std::uninitialized_copy(from, from + count, to);
+        }
+    }
+
+    // Builds count elements at gap through fill; destroys any it built if one throws.
+    template <typename ValueAt>
+    static void _construct(T* gap, int count, ValueAt& valueAt) {
+        int built = 0;
+        try {
+            for (; built < count; ++built) {
+                ::new (static_cast<void*>(gap + built)) T(valueAt(built));
+            }
+        } catch (...) {
+            std::destroy(gap, gap + built);
+            throw;
+        }
+    }
+
+    int _frontRoom() const {
+        return static_cast<int>(data - buffer);
+    }
+
+    int _backRoom() const {
+        return capacity - _frontRoom() - size;
+    }
+
+    // Moves the elements into a new buffer of newCapacity slots starting at newFront,
+    // with count slots at index built by fill(gap) first. Either everything succeeds and
+    // the old buffer is released, or the new buffer is freed and nothing changes.
+    template <typename Fill>
+    void _rebuild(int newCapacity, int newFront, int index, int count, Fill fill) {
+        T* newBuffer = _allocate(newCapacity);
+        T* newData = newBuffer + newFront;
+
+        try {
+            fill(newData + index);
+            try {
+                _transfer(data, index, newData);
+                try {
+                    _transfer(data + index, size - index, newData + index + count);
+                } catch (...) {
+                    std::destroy(newData, newData + index);
+                    throw;
+                }
+            } catch (...) {
+                std::destroy(newData + index, newData + index + count);
+                throw;
+            }
+        } catch (...) {
+            _deallocate(newBuffer, newCapacity);
+            throw;
+        }
+
+        std::destroy(data, data + size);
+        _deallocate(buffer, capacity);
+        buffer = newBuffer;
+        data = newData;
+        capacity = newCapacity;
+        size += count;
+    }
+
+    void _reallocate(int newCapacity, int newFront) {
+        _rebuild(newCapacity, newFront, size, 0, [](T*) {});
+    }
+
+    // Inserts count elements at index, built by fill(gap). The shorter side is shifted when
+    // it has room; otherwise the elements are recentred in place if at least half the
+    // buffer is free, or moved into a buffer twice as large. Types with a throwing move
+    // always go through _rebuild. If fill throws, the contents are unchanged.
+    template <typename Fill>
+    void _insertGap(int index, int count, Fill fill) {
+        int front = _frontRoom();
+        int back = _backRoom();
+        bool frontCloser = index * 2 < size;
+        bool recentre = front + back - count >= size;
+
+        if (!_nothrowRelocate || (!(frontCloser && count <= front) && !(!frontCloser && count <= back) && !recentre)) {
+            int newCapacity = _nothrowRelocate || !recentre ? std::max(capacity * 2, _getCapacity(size + count)) : capacity;
+            int extra = newCapacity - size - count;
+            int newFront = index == 0 ? extra : index == size ? std::min(front, extra) : extra / 2;
+            _rebuild(newCapacity, newFront, index, count, fill);
+            return;
+        }
+
+        if (frontCloser && count <= front) {
+            _relocate(data, index, data - count);
+            data -= count;
+        } else if (!frontCloser && count <= back) {
+            _relocate(data + index, size - index, data + index + count);
+        } else {
+            T* newData = buffer + (front + back - count) / 2;
+
+            if (newData < data) {
+                _relocate(data, index, newData);
+                _relocate(data + index, size - index, newData + index + count);
+            } else {
+                _relocate(data + index, size - index, newData + index + count);
+                _relocate(data, index, newData);
+            }
+            data = newData;
+        }
+
+        try {
+            fill(data + index);
+        } catch (...) {
+            _relocate(data + index + count, size - index, data + index);
+            throw;
+        }
+        size += count;
+    }
+
+    void _release() {
+        std::destroy(data, data + size);
+        _deallocate(buffer, capacity);
+        buffer = data = nullptr;
+        size = capacity = 0;
+    }
+
 public:
-    DynamicArray(): data(nullptr), size(0), capacity(0) {}
+    DynamicArray(): buffer(nullptr), data(nullptr), size(0), capacity(0) {}
 
     DynamicArray(int initialCapacity) : size(initialCapacity), capacity(_getCapacity(initialCapacity)) {
-        data = new T[capacity];
+        buffer = data = _allocate(capacity);
+        std::uninitialized_value_construct(data, data + size);
     }
 
     DynamicArray(const T* items, int count) : size(count), capacity(_getCapacity(count)) {
-        data = new T[capacity];
-        std::copy(items, items + count, data);
+        buffer = data = _allocate(capacity);
+        std::uninitialized_copy(items, items + count, data);
     }
 
-    DynamicArray(const DynamicArray& other) : size(other.size), capacity(other.capacity) {
-        data = new T[capacity];
-        std::copy(other.data, other.data + size, data);
+    DynamicArray(const DynamicArray& other) : size(other.size), capacity(_getCapacity(other.size)) {
+        buffer = data = _allocate(capacity);
+        std::uninitialized_copy(other.data, other.data + size, data);
+    }
+
+    DynamicArray(DynamicArray&& other) noexcept :
+        buffer(other.buffer), data(other.data), size(other.size), capacity(other.capacity) {
+        other.buffer = other.data = nullptr;
+        other.size = other.capacity = 0;
     }
 
     ~DynamicArray() {
-        delete[] data;
+        _release();
+    }
+
+    DynamicArray& operator=(const DynamicArray& other) {
+        if (this != &other) {
+            DynamicArray copy(other);
+            *this = std::move(copy);
+        }
+        return *this;
+    }
+
+    DynamicArray& operator=(DynamicArray&& other) noexcept {
+        if (this != &other) {
+            _release();
+            buffer = other.buffer;
+            data = other.data;
+            size = other.size;
+            capacity = other.capacity;
+
+            other.buffer = other.data = nullptr;
+            other.size = other.capacity = 0;
+        }
+        return *this;
     }
 
     T& operator[](int index) {
         _checkException(index);
-        
+
         return data[index];
     }
 
@@ -61,21 +259,148 @@ public:
         return capacity;
     }
 
+    // Unused slots on either side of the elements count as slack.
+    MemoryUsage GetMemoryUsage() const {
+        MemoryUsage usage;
+        usage.payload = sizeof(T) * size;
+        usage.overhead = sizeof(*this);
+        usage.slack = sizeof(T) * (capacity - size);
+        if constexpr (OwnedHeap<T>::Tracked) {
+            for (int i = 0; i < size; ++i) {
+                usage.payload += OwnedHeap<T>::Bytes(data[i]);
+            }
+        }
+        return usage;
+    }
+
+    T* GetData() const {
+        return data;
+    }
+
+    void Reserve(int newCapacity) {
+        if (newCapacity > capacity - _frontRoom()) {
+            _reallocate(std::max(_getCapacity(newCapacity), size), 0);
+        }
+    }
+
+    void ShrinkToFit() {
+        if (capacity != size) {
+            _reallocate(size, 0);
+        }
+    }
+
     void Resize(int newSize) {
-        int newCapacity = _getCapacity(newSize);
-        if (capacity == newCapacity) { 
-            size = newSize;
-            return;
+        if (newSize < 0) {
+            throw std::invalid_argument("Size must be non-negative");
         }
 
-        T* newData = new T[newCapacity];
-        std::copy(data, data + std::min(size, newSize), newData);
-        delete[] data;
-        data = newData;
-        capacity = newCapacity;
+        if (newSize < size) {
+            std::destroy(data + newSize, data + size);
+        } else {
+            Reserve(newSize);
+            std::uninitialized_value_construct(data + size, data + newSize);
+        }
+        size = newSize;
+    }
+
+    // Like Resize, but new elements are default-initialised, so trivial types are left
+    // uninitialised for the caller to overwrite.
+    void ResizeForOverwrite(int newSize) {
+        if (newSize < 0) {
+            throw std::invalid_argument("Size must be non-negative");
+        }
+
+        if (newSize < size) {
+            std::destroy(data + newSize, data + size);
+        } else {
+            Reserve(newSize);
+            std::uninitialized_default_construct(data + size, data + newSize);
+        }
         size = newSize;
     }
 
+    template <typename... Args>
+    T& EmplaceBack(Args&&... args) {
+        if (_backRoom() > 0) {
+            ::new (static_cast<void*>(data + size)) T(std::forward<Args>(args)...);
+        } else if (_frontRoom() > size) {
+            T item(std::forward<Args>(args)...);
+            _insertGap(size, 1, [&item](T* gap) {
+                ::new (static_cast<void*>(gap)) T(std::move(item));
+            });
+            return data[size - 1];
+        } else {
+            // The new element is built first, so args may still refer to an element here.
+            int newCapacity = capacity ? capacity * 2 : 1;
+            int newFront = std::min(_frontRoom(), newCapacity - size - 1);
+            _rebuild(newCapacity, newFront, size, 1, [&](T* gap) {
+                ::new (static_cast<void*>(gap)) T(std::forward<Args>(args)...);
+            });
+            return data[size - 1];
+        }
+
+        return data[size++];
+    }
+
+    template <typename... Args>
+    T& EmplaceFront(Args&&... args) {
+        return EmplaceAt(0, std::forward<Args>(args)...);
+    }
+
+    template <typename... Args>
+    T& EmplaceAt(int index, Args&&... args) {
+        if (index < 0 || index > size) {
+            throw std::out_of_range("Index out of range");
+        }
+        if (index == size) {
+            return EmplaceBack(std::forward<Args>(args)...);
+        }
+
+        T item(std::forward<Args>(args)...);
+        _insertGap(index, 1, [&item](T* gap) {
+            ::new (static_cast<void*>(gap)) T(std::move(item));
+        });
+        return data[index];
+    }
+
+    void InsertAt(const T& value, int index) {
+        EmplaceAt(index, value);
+    }
+
+    template <typename ValueAt>
+    void InsertRange(int index, int count, ValueAt valueAt) {
+        if (index < 0 || index > size) {
+            throw std::out_of_range("Index out of range");
+        }
+        if (count <= 0) return;
+
+        _insertGap(index, count, [count, &valueAt](T* gap) {
+            _construct(gap, count, valueAt);
+        });
+    }
+
+    void InsertRange(int index, const T* items, int count) {
+        InsertRange(index, count, [items](int i) -> const T& { return items[i]; });
+    }
+
+    void RemoveAt(int index) {
+        _checkException(index);
+
+        if constexpr (!_nothrowRelocate) {
+            std::move(data + index + 1, data + size, data + index);
+            std::destroy_at(data + size - 1);
+        } else {
+            std::destroy_at(data + index);
+            if (index * 2 < size) {
+                _relocate(data, index, data + 1);
+                ++data;
+            } else {
+                _relocate(data + index + 1, size - index - 1, data + index);
+            }
+        }
+        --size;
+    }
+
     void Set(const T& value, int index) {
         _checkException(index);
 
@@ -0,0 +1,135 @@
+#pragma once
+#include <stdexcept>
+#include <utility>
+#include "DynamicArray.hpp"
+
+
+class FenwickTree {
+private:
+    DynamicArray<int>* tree;
+    int count;
+
+    static int _lowBit(int i) {
+        return i & -i;
+    }
+
+    int _sum(int count_) const {
+        int result = 0;
+        for (int i = count_; i > 0; i -= _lowBit(i)) {
+            result += tree->Get(i);
+        }
+        return result;
+    }
+
+    // A moved-from tree has no storage until it is built or appended to again.
+    void _ensureStorage() {
+        if (!tree) {
+            tree = new DynamicArray<int>(1);
+            tree->Set(0, 0);
+        }
+    }
+
+public:
+    FenwickTree() : tree(new DynamicArray<int>(1)), count(0) {
+        tree->Set(0, 0);
+    }
+
+    FenwickTree(const FenwickTree& other) :
+        tree(other.tree ? new DynamicArray<int>(*other.tree) : nullptr), count(other.count) {}
+
+    FenwickTree(FenwickTree&& other) noexcept : tree(std::exchange(other.tree, nullptr)), count(std::exchange(other.count, 0)) {}
+
+    FenwickTree& operator=(const FenwickTree& other) {
+        if (this != &other) {
+            DynamicArray<int>* copy = other.tree ? new DynamicArray<int>(*other.tree) : nullptr;
+            delete tree;
+            tree = copy;
+            count = other.count;
+        }
+        return *this;
+    }
+
+    FenwickTree& operator=(FenwickTree&& other) noexcept {
+        if (this != &other) {
+            delete tree;
+            tree = std::exchange(other.tree, nullptr);
+            count = std::exchange(other.count, 0);
+        }
+        return *this;
+    }
+
+    ~FenwickTree() {
+        delete tree;
+    }
+
+    int GetSize() const {
+        return count;
+    }
+
+    // The whole index is bookkeeping for its owner, so it is all reported as overhead.
+    MemoryUsage GetMemoryUsage() const {
+        MemoryUsage usage;
+        usage.overhead = sizeof(*this) + (tree ? tree->GetMemoryUsage().Total() : 0);
+        return usage;
+    }
+
+    template <typename ValueAt>
+    void Build(int count_, ValueAt valueAt) {
+        _ensureStorage();
+        count = count_;
+        tree->Resize(count + 1);
+        tree->Set(0, 0);
+
+        for (int i = 1; i <= count; ++i) {
+            tree->Set(valueAt(i - 1), i);
+        }
+        for (int i = 1; i <= count; ++i) {
+            int parent = i + _lowBit(i);
+            if (parent <= count) {
+                tree->Get(parent) += tree->Get(i);
+            }
+        }
+    }
+
+    void Add(int index, int delta) {
+        if (index < 0 || index >= count) {
+            throw std::out_of_range("FenwickTree index out of range");
+        }
+
+        for (int i = index + 1; i <= count; i += _lowBit(i)) {
+            tree->Get(i) += delta;
+        }
+    }
+
+    void Append(int value) {
+        _ensureStorage();
+        int i = count + 1;
+        tree->Resize(i + 1);
+        tree->Set(value + _sum(i - 1) - _sum(i - _lowBit(i)), i);
+        count = i;
+    }
+
+    int PrefixSum(int count_) const {
+        if (count_ < 0 || count_ > count) {
+            throw std::out_of_range("FenwickTree index out of range");
+        }
+
+        return _sum(count_);
+    }
+
+    int Find(int target, int& offset) const {
+        int step = 1;
+        while (step * 2 <= count) step <<= 1;
+
+        int pos = 0;
+        for (; step > 0; step >>= 1) {
+            if (pos + step <= count && tree->Get(pos + step) <= target) {
+                pos += step;
+                target -= tree->Get(pos);
+            }
+        }
+
+        offset = target;
+        return pos;
+    }
+};
@@ -2,6 +2,13 @@
 #include <iostream>
 #include <stdexcept>
 #include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include "MemoryUsage.hpp"
+#include "NodePool.hpp"
 
 
 template <typename T>
@@ -15,39 +22,277 @@ private:
         Node(const T& value) : data(value), next(nullptr), prev(nullptr) {}
     };
 
+    using Pool = NodePool<Node>;
+    using Slot = typename Pool::Slot;
+
+    // Slots taken from the shared pool at once: the largest power of two not above the
+    // list size, capped at SpareBatch, so short lists do not sit on 64 unused slots.
+    // Each list keeps up to twice a batch of freed slots before handing the surplus back.
+    static constexpr int SpareBatch = 64;
+
     Node* head;
     Node* tail;
     int size;
+    Slot* spare;
+    int spareCount;
 
     void _checkException(int index) const {
-        if (index >= size) {
+        if (index < 0 || index >= size) {
             throw std::out_of_range("Index out of range");
         }
     }
 
+    int _spareBatch() const {
+        int batch = 1;
+        while (batch < SpareBatch && batch * 2 <= size) {
+            batch <<= 1;
+        }
+        return batch;
+    }
+
+    Node* _createNode(const T& value) {
+        if (spare == nullptr) {
+            spareCount = _spareBatch();
+            spare = Pool::Shared().Take(spareCount);
+        }
+
+        Slot* slot = spare;
+        spare = slot->next;
+        --spareCount;
+
+        try {
+            return ::new (static_cast<void*>(slot->storage)) Node(value);
+        } catch (...) {
+            _releaseSlot(slot);
+            throw;
+        }
+    }
+
+    void _destroyNode(Node* node) {
+        node->~Node();
+        _releaseSlot(reinterpret_cast<Slot*>(node));
+    }
+
+    void _releaseSlot(Slot* slot) {
+        slot->next = spare;
+        spare = slot;
+
+        int batch = _spareBatch();
+        if (++spareCount > 2 * batch) {
+            Slot* last = spare;
+            for (int i = 1; i < batch; ++i) {
+                last = last->next;
+            }
+            Pool::Shared().Give(last->next, _lastSlot(last->next));
+            last->next = nullptr;
+            spareCount = batch;
+        }
+    }
+
+    static Slot* _lastSlot(Slot* slot) {
+        while (slot != nullptr && slot->next != nullptr) {
+            slot = slot->next;
+        }
+        return slot;
+    }
+
+    // Walks from whichever end is nearer to index.
+    Node* _nodeAt(int index) const {
+        if (index * 2 < size) {
+            Node* current = head;
+            for (int i = 0; i < index; ++i) {
+                current = current->next;
+            }
+            return current;
+        }
+
+        Node* current = tail;
+        for (int i = size - 1; i > index; --i) {
+            current = current->prev;
+        }
+        return current;
+    }
+
+    // Links the chain first..last of count nodes in front of position (at the end if null).
+    void _linkBefore(Node* position, Node* first, Node* last, int count) {
+        Node* before = position ? position->prev : tail;
+
+        first->prev = before;
+        last->next = position;
+        if (before) {
+            before->next = first;
+        } else {
+            head = first;
+        }
+        if (position) {
+            position->prev = last;
+        } else {
+            tail = last;
+        }
+        size += count;
+    }
+
+    void _unlink(Node* first, Node* last, int count) {
+        if (first->prev) {
+            first->prev->next = last->next;
+        } else {
+            head = last->next;
+        }
+        if (last->next) {
+            last->next->prev = first->prev;
+        } else {
+            tail = first->prev;
+        }
+
+        first->prev = nullptr;
+        last->next = nullptr;
+        size -= count;
+    }
+
 public:
-    LinkedList(): head(nullptr), tail(nullptr), size(0) {}
-    LinkedList(const T* items, int count) : head(nullptr), tail(nullptr), size(0) {
+    // Bidirectional cursor over the nodes. It stays valid while its node is in the list,
+    // whatever is inserted or erased elsewhere.
+    template <bool IsConst, bool IsReverse>
+    class Cursor {
+    private:
+        friend class LinkedList<T>;
+        friend class Cursor<!IsConst, IsReverse>;
+
+        using List = std::conditional_t<IsConst, const LinkedList<T>, LinkedList<T>>;
+
+        Node* node;
+        List* list;
+
+        Cursor(Node* node_, List* list_) : node(node_), list(list_) {}
+
+    public:
+        using iterator_category = std::bidirectional_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = std::conditional_t<IsConst, const T*, T*>;
+        using reference = std::conditional_t<IsConst, const T&, T&>;
+
+        Cursor() : node(nullptr), list(nullptr) {}
+
+        template <bool OtherConst, typename = std::enable_if_t<IsConst && !OtherConst>>
+        Cursor(const Cursor<OtherConst, IsReverse>& other) : node(other.node), list(other.list) {}
+
+        reference operator*() const {
+            return node->data;
+        }
+
+        pointer operator->() const {
+            return &node->data;
+        }
+
+        Cursor& operator++() {
+            node = IsReverse ? node->prev : node->next;
+            return *this;
+        }
+
+        Cursor operator++(int) {
+            Cursor old = *this;
+            ++*this;
+            return old;
+        }
+
+        // Stepping back from the end cursor lands on the last element.
+        Cursor& operator--() {
+            if (node == nullptr) {
+                node = IsReverse ? list->head : list->tail;
+            } else {
+                node = IsReverse ? node->next : node->prev;
+            }
+            return *this;
+        }
+
+        Cursor operator--(int) {
+            Cursor old = *this;
+            --*this;
+            return old;
+        }
+
+        bool operator==(const Cursor& other) const {
+            return node == other.node;
+        }
+
+        bool operator!=(const Cursor& other) const {
+            return node != other.node;
+        }
+    };
+
+    using Iterator = Cursor<false, false>;
+    using ConstIterator = Cursor<true, false>;
+    using ReverseIterator = Cursor<false, true>;
+    using ConstReverseIterator = Cursor<true, true>;
+
+    LinkedList(): head(nullptr), tail(nullptr), size(0), spare(nullptr), spareCount(0) {}
+    LinkedList(const T* items, int count) : LinkedList() {
         for (int i = 0; i < count; ++i) {
             Append(items[i]);
         }
     }
-    LinkedList(const LinkedList<T>& other) : head(nullptr), tail(nullptr), size(0) {
+    LinkedList(const LinkedList<T>& other) : LinkedList() {
         for (Node* current = other.head; current != nullptr; current = current->next) {
             Append(current->data);
         }
     }
 
+    // The spare slots move with the nodes, so no slot is ever owned by two lists.
+    LinkedList(LinkedList<T>&& other) noexcept :
+        head(other.head), tail(other.tail), size(other.size), spare(other.spare), spareCount(other.spareCount) {
+        other.head = other.tail = nullptr;
+        other.spare = nullptr;
+        other.size = other.spareCount = 0;
+    }
+
     ~LinkedList() {
         Clear();
+        Pool::Shared().Give(spare, _lastSlot(spare));
+    }
+
+    LinkedList<T>& operator=(const LinkedList<T>& other) {
+        if (this != &other) {
+            LinkedList<T> copy(other);
+            *this = std::move(copy);
+        }
+        return *this;
+    }
+
+    LinkedList<T>& operator=(LinkedList<T>&& other) noexcept {
+        if (this != &other) {
+            Clear();
+            Pool::Shared().Give(spare, _lastSlot(spare));
+
+            head = other.head;
+            tail = other.tail;
+            size = other.size;
+            spare = other.spare;
+            spareCount = other.spareCount;
+
+            other.head = other.tail = nullptr;
+            other.spare = nullptr;
+            other.size = other.spareCount = 0;
+        }
+        return *this;
     }
 
+    // Destroys every element and hands all nodes back to the pool under one lock.
     void Clear() {
+        Slot* first = nullptr;
+        Slot* last = nullptr;
+
         while (head != nullptr) {
             Node* temp = head;
             head = head->next;
-            delete temp;
+            temp->~Node();
+
+            Slot* slot = reinterpret_cast<Slot*>(temp);
+            slot->next = first;
+            first = slot;
+            if (last == nullptr) last = slot;
         }
+        Pool::Shared().Give(first, last);
 
         tail = nullptr;
         size = 0;
@@ -57,8 +302,22 @@ public:
         return size;
     }
 
+    // Links count as overhead; pooled slots the list keeps for reuse count as slack.
+    MemoryUsage GetMemoryUsage() const {
+        MemoryUsage usage;
+        usage.payload = sizeof(T) * size;
+        usage.overhead = sizeof(*this) + (sizeof(Slot) - sizeof(T)) * size;
+        usage.slack = sizeof(Slot) * spareCount;
+        if constexpr (OwnedHeap<T>::Tracked) {
+            ForEach([&usage](const T& item) {
+                usage.payload += OwnedHeap<T>::Bytes(item);
+            });
+        }
+        return usage;
+    }
+
     void Append(const T& value) {
-        Node* newNode = new Node(value);
+        Node* newNode = _createNode(value);
         if (tail == nullptr) {
             head = tail = newNode;
         } else {
@@ -70,7 +329,7 @@ public:
     }
 
     void Prepend(const T& value) {
-        Node* newNode = new Node(value);
+        Node* newNode = _createNode(value);
         if (head == nullptr) {
             head = tail = newNode;
         } else {
@@ -81,13 +340,100 @@ public:
         ++size;
     }
 
-    T& Get(int index) const {
+    template <typename Visitor>
+    void ForEach(Visitor visit) const {
+        for (Node* current = head; current != nullptr; current = current->next) {
+            visit(current->data);
+        }
+    }
+
+    template <typename Visitor>
+    bool ForEachWhile(Visitor visit) const {
+        for (Node* current = head; current != nullptr; current = current->next) {
+            if (!visit(current->data)) return false;
+        }
+        return true;
+    }
+
+    Iterator begin() {
+        return Iterator(head, this);
+    }
+
+    Iterator end() {
+        return Iterator(nullptr, this);
+    }
+
+    ConstIterator begin() const {
+        return ConstIterator(head, this);
+    }
+
+    ConstIterator end() const {
+        return ConstIterator(nullptr, this);
+    }
+
+    ConstIterator cbegin() const {
+        return begin();
+    }
+
+    ConstIterator cend() const {
+        return end();
+    }
+
+    ReverseIterator rbegin() {
+        return ReverseIterator(tail, this);
+    }
+
+    ReverseIterator rend() {
+        return ReverseIterator(nullptr, this);
+    }
+
+    ConstReverseIterator rbegin() const {
+        return ConstReverseIterator(tail, this);
+    }
+
+    ConstReverseIterator rend() const {
+        return ConstReverseIterator(nullptr, this);
+    }
+
+    // Cursor at index, reached from the nearer end.
+    Iterator At(int index) {
         _checkException(index);
-        Node* current = head;
-        for (int i = 0; i < index; ++i) {
-            current = current->next;
+        return Iterator(_nodeAt(index), this);
+    }
+
+    // Inserts item right after position and returns a cursor to it.
+    Iterator InsertAfter(Iterator position, const T& item) {
+        if (position.node == nullptr) {
+            throw std::out_of_range("Cannot insert after the end");
         }
-        return current->data;
+
+        Node* newNode = _createNode(item);
+        _linkBefore(position.node->next, newNode, newNode, 1);
+        return Iterator(newNode, this);
+    }
+
+    // Inserts item in front of position (at the end for end()) and returns a cursor to it.
+    Iterator InsertBefore(Iterator position, const T& item) {
+        Node* newNode = _createNode(item);
+        _linkBefore(position.node, newNode, newNode, 1);
+        return Iterator(newNode, this);
+    }
+
+    // Removes the element at position and returns a cursor to the one after it.
+    Iterator Erase(Iterator position) {
+        if (position.node == nullptr) {
+            throw std::out_of_range("Cannot erase the end");
+        }
+
+        Node* next = position.node->next;
+        _unlink(position.node, position.node, 1);
+        _destroyNode(position.node);
+        return Iterator(next, this);
+    }
+
+    T& Get(int index) const {
+        _checkException(index);
+        return _nodeAt(index)->data;
     }
 
     T& GetFirst() const {
@@ -109,11 +455,8 @@ public:
         } else if (index == size) {
             Append(item);
         } else {
-            Node* newNode = new Node(item);
-            Node* current = head;
-            for (int i = 0; i < index; ++i) {
-                current = current->next;
-            }
+            Node* newNode = _createNode(item);
+            Node* current = _nodeAt(index);
             newNode->prev = current->prev;
             newNode->next = current;
             current->prev->next = newNode;
@@ -122,6 +465,14 @@ public:
         }
     }
 
+    void RemoveAt(int index) {
+        _checkException(index);
+
+        Node* current = _nodeAt(index);
+        _unlink(current, current, 1);
+        _destroyNode(current);
+    }
+
     LinkedList<T>* Concat(const LinkedList<T>* list) {
         LinkedList<T>* result = new LinkedList<T>(*this);
 
@@ -140,20 +491,13 @@ public:
 
         LinkedList<T>* result = new LinkedList<T>();
 
+        Node* current = _nodeAt(startIndex);
         if (startIndex <= endIndex) {
-            Node* current = head;
-            for (int i = 0; i < startIndex; ++i) {
-                current = current->next;
-            }
             for (int i = startIndex; i <= endIndex; ++i) {
                 result->Append(current->data);
                 current = current->next;
             }
         } else {
-            Node* current = tail;
-            for (int i = size - 1; startIndex < i; --i) {
-                current = current->prev;
-            }
             for (int i = startIndex; endIndex <= i; --i) {
                 result->Append(current->data);
                 current = current->prev;
@@ -162,4 +506,52 @@ public:
 
         return result;
     }
-};
\ No newline at end of file
+
+    // Moves all nodes of other in front of index (0..GetSize()), leaving other empty.
+    // No element is copied; only the walk to index depends on the list length.
+    void Splice(int index, LinkedList<T>& other) {
+        if (index < 0 || index > size) {
+            throw std::out_of_range("Index out of range");
+        }
+        if (&other == this) {
+            throw std::invalid_argument("Cannot splice a list into itself");
+        }
+        if (other.size == 0) return;
+
+        Node* first = other.head;
+        Node* last = other.tail;
+        int count = other.size;
+        other.head = other.tail = nullptr;
+        other.size = 0;
+
+        _linkBefore(index == size ? nullptr : _nodeAt(index), first, last, count);
+    }
+
+    // O(1) concatenation that steals the nodes of other.
+    void MoveConcat(LinkedList<T>& other) {
+        Splice(size, other);
+    }
+
+    // Unlinks the nodes startIndex..endIndex and returns them as a new list without
+    // copying the elements.
+    LinkedList<T>* ExtractSubList(int startIndex, int endIndex) {
+        _checkException(startIndex);
+        _checkException(endIndex);
+        if (startIndex > endIndex) {
+            throw std::invalid_argument("startIndex must not exceed endIndex");
+        }
+
+        Node* first = _nodeAt(startIndex);
+        Node* last = first;
+        for (int i = startIndex; i < endIndex; ++i) {
+            last = last->next;
+        }
+
+        int count = endIndex - startIndex + 1;
+        _unlink(first, last, count);
+
+        LinkedList<T>* result = new LinkedList<T>();
+        result->_linkBefore(nullptr, first, last, count);
+        return result;
+    }
+};
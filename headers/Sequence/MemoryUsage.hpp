@@ -0,0 +1,63 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#include <utility>
+
+
+// Bytes held by a container, split three ways:
+//   payload   the elements themselves plus heap memory they own;
+//   overhead  the container object, node links and other bookkeeping;
+//   slack     memory allocated for elements that is not in use.
+// Allocator headers and padding inside malloc are not visible and not counted.
+struct MemoryUsage {
+    std::size_t payload = 0;
+    std::size_t overhead = 0;
+    std::size_t slack = 0;
+
+    std::size_t Total() const {
+        return payload + overhead + slack;
+    }
+
+    MemoryUsage& operator+=(const MemoryUsage& other) {
+        payload += other.payload;
+        overhead += other.overhead;
+        slack += other.slack;
+        return *this;
+    }
+
+    friend MemoryUsage operator+(MemoryUsage lhs, const MemoryUsage& rhs) {
+        lhs += rhs;
+        return lhs;
+    }
+};
+
+// Heap memory owned by one element beyond sizeof(T). Containers only walk their
+// elements when Tracked is true, so the report stays O(1) for types such as int.
+// Interned strings (Person names and departments) are shared and reported by StringPool.
+template <typename T>
+struct OwnedHeap {
+    static constexpr bool Tracked = false;
+
+    static std::size_t Bytes(const T&) {
+        return 0;
+    }
+};
+
+template <>
+struct OwnedHeap<std::string> {
+    static constexpr bool Tracked = true;
+
+    static std::size_t Bytes(const std::string& value) {
+        static const std::size_t inlineCapacity = std::string().capacity();
+        return value.capacity() > inlineCapacity ? value.capacity() + 1 : 0;
+    }
+};
+
+template <typename First, typename Second>
+struct OwnedHeap<std::pair<First, Second>> {
+    static constexpr bool Tracked = OwnedHeap<First>::Tracked || OwnedHeap<Second>::Tracked;
+
+    static std::size_t Bytes(const std::pair<First, Second>& value) {
+        return OwnedHeap<First>::Bytes(value.first) + OwnedHeap<Second>::Bytes(value.second);
+    }
+};
@@ -0,0 +1,89 @@
+#pragma once
+#include <algorithm>
+#include <mutex>
+#include <new>
+
+
+// Slab allocator for fixed-size list nodes. Slots are carved out of large slabs and
+// recycled through a free list instead of going back to malloc; slabs are only
+// released when the pool is destroyed. Callers take and return slots in chains, so a
+// container can keep a few spare slots of its own and touch the lock only once per batch.
+template <typename Node>
+class NodePool {
+public:
+    union Slot {
+        Slot* next;
+        alignas(Node) unsigned char storage[sizeof(Node)];
+    };
+
+private:
+    static constexpr int SlabBytes = 64 * 1024;
+    static constexpr int SlotsPerSlab = std::max<int>(64, SlabBytes / sizeof(Slot));
+
+    struct Slab {
+        Slab* next;
+        Slot slots[SlotsPerSlab];
+    };
+
+    std::mutex mutex;
+    Slab* slabs;
+    Slot* freeList;
+
+    void addSlab() {
+        Slab* slab = new Slab;
+        slab->next = slabs;
+        slabs = slab;
+
+        for (int i = 0; i < SlotsPerSlab - 1; ++i) {
+            slab->slots[i].next = &slab->slots[i + 1];
+        }
+        slab->slots[SlotsPerSlab - 1].next = freeList;
+        freeList = &slab->slots[0];
+    }
+
+public:
+    NodePool() : slabs(nullptr), freeList(nullptr) {}
+
+    NodePool(const NodePool&) = delete;
+    NodePool& operator=(const NodePool&) = delete;
+
+    ~NodePool() {
+        while (slabs != nullptr) {
+            Slab* next = slabs->next;
+            delete slabs;
+            slabs = next;
+        }
+    }
+
+    // Pool shared by every container of this node type. It is never destroyed, so
+    // containers with static storage duration can still release nodes at exit.
+    static NodePool& Shared() {
+        static NodePool* pool = new NodePool();
+        return *pool;
+    }
+
+    // Unlinks count free slots and returns them as a null-terminated chain.
+    Slot* Take(int count) {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        Slot* first = nullptr;
+        for (int i = 0; i < count; ++i) {
+            if (freeList == nullptr) addSlab();
+
+            Slot* slot = freeList;
+            freeList = slot->next;
+            slot->next = first;
+            first = slot;
+        }
+        return first;
+    }
+
+    // Returns the chain first..last, which must be linked through Slot::next.
+    void Give(Slot* first, Slot* last) {
+        if (first == nullptr) return;
+
+        std::lock_guard<std::mutex> lock(mutex);
+        last->next = freeList;
+        freeList = first;
+    }
+};
@@ -0,0 +1,356 @@
+#pragma once
+#include <algorithm>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+#include "DynamicArray.hpp"
+
+
+// Immutable array kept as a height-balanced tree of small leaf chunks. Every update
+// returns a new version that copies only the O(log n) nodes on the changed path and
+// shares the rest with the old version, so copies are O(1) and Get, Set, InsertAt,
+// RemoveAt, Concat and GetSubArray are O(log n).
+template <typename T>
+class PersistentArray {
+private:
+    static constexpr int LeafCapacity = 32;
+
+    struct Node;
+    using NodePtr = std::shared_ptr<const Node>;
+
+    struct Node {
+        NodePtr left;
+        NodePtr right;
+        DynamicArray<T> items;
+        int length;
+        int height;
+
+        explicit Node(DynamicArray<T>&& items_) :
+            items(std::move(items_)), length(items.GetSize()), height(1) {}
+
+        Node(NodePtr left_, NodePtr right_) :
+            left(std::move(left_)), right(std::move(right_)),
+            length(left->length + right->length),
+            height(1 + std::max(left->height, right->height)) {}
+
+        bool isLeaf() const {
+            return !left;
+        }
+    };
+
+    NodePtr root;
+
+    explicit PersistentArray(NodePtr root_) : root(std::move(root_)) {}
+
+    void _checkException(int index) const {
+        if (index < 0 || index >= length(root)) {
+            throw std::out_of_range("Index out of range");
+        }
+    }
+
+    static int length(const NodePtr& node) {
+        return node ? node->length : 0;
+    }
+
+    static int height(const NodePtr& node) {
+        return node ? node->height : 0;
+    }
+
+    static NodePtr makeLeaf(DynamicArray<T>&& items) {
+        return std::make_shared<Node>(std::move(items));
+    }
+
+    static NodePtr makeLeaf(const T* items, int count) {
+        return makeLeaf(DynamicArray<T>(items, count));
+    }
+
+    static NodePtr makeNode(NodePtr left, NodePtr right) {
+        return std::make_shared<Node>(std::move(left), std::move(right));
+    }
+
+    // Concatenates two subtrees whose heights differ by at most two.
+    static NodePtr balanced(const NodePtr& left, const NodePtr& right) {
+        if (!left) return right;
+        if (!right) return left;
+
+        if (height(left) > height(right) + 1) {
+            if (height(left->left) >= height(left->right)) {
+                return makeNode(left->left, makeNode(left->right, right));
+            }
+            return makeNode(makeNode(left->left, left->right->left), makeNode(left->right->right, right));
+        }
+        if (height(right) > height(left) + 1) {
+            if (height(right->right) >= height(right->left)) {
+                return makeNode(makeNode(left, right->left), right->right);
+            }
+            return makeNode(makeNode(left, right->left->left), makeNode(right->left->right, right->right));
+        }
+        return makeNode(left, right);
+    }
+
+    static NodePtr join(const NodePtr& left, const NodePtr& right) {
+        if (!left) return right;
+        if (!right) return left;
+
+        if (height(left) > height(right) + 1) {
+            return balanced(left->left, join(left->right, right));
+        }
+        if (height(right) > height(left) + 1) {
+            return balanced(join(left, right->left), right->right);
+        }
+        return makeNode(left, right);
+    }
+
+    static NodePtr build(const NodePtr* leaves, int begin, int end) {
+        if (end - begin == 1) return leaves[begin];
+
+        int mid = begin + (end - begin) / 2;
+        return makeNode(build(leaves, begin, mid), build(leaves, mid, end));
+    }
+
+    static NodePtr insert(const NodePtr& node, int index, const T& item) {
+        if (!node) return makeLeaf(&item, 1);
+
+        if (node->isLeaf()) {
+            int count = node->length;
+            if (count < LeafCapacity) {
+                DynamicArray<T> items(node->items);
+                items.InsertAt(item, index);
+                return makeLeaf(std::move(items));
+            }
+
+            // A full leaf grows a new neighbour at its edges so appends and prepends
+            // keep leaves full; inserts in the middle split it in half.
+            if (index == count) return makeNode(node, makeLeaf(&item, 1));
+            if (index == 0) return makeNode(makeLeaf(&item, 1), node);
+
+            DynamicArray<T> items(node->items);
+            items.InsertAt(item, index);
+            const T* first = items.GetData();
+            int half = items.GetSize() / 2;
+            return makeNode(makeLeaf(first, half), makeLeaf(first + half, items.GetSize() - half));
+        }
+
+        if (index <= length(node->left) && index < node->length) {
+            return balanced(insert(node->left, index, item), node->right);
+        }
+        return balanced(node->left, insert(node->right, index - length(node->left), item));
+    }
+
+    static NodePtr set(const NodePtr& node, int index, const T& value) {
+        if (node->isLeaf()) {
+            DynamicArray<T> items(node->items);
+            items.Set(value, index);
+            return makeLeaf(std::move(items));
+        }
+
+        if (index < length(node->left)) {
+            return makeNode(set(node->left, index, value), node->right);
+        }
+        return makeNode(node->left, set(node->right, index - length(node->left), value));
+    }
+
+    static NodePtr remove(const NodePtr& node, int index) {
+        if (node->isLeaf()) {
+            if (node->length == 1) return nullptr;
+
+            DynamicArray<T> items(node->items);
+            items.RemoveAt(index);
+            return makeLeaf(std::move(items));
+        }
+
+        if (index < length(node->left)) {
+            return join(remove(node->left, index), node->right);
+        }
+        return join(node->left, remove(node->right, index - length(node->left)));
+    }
+
+    static void split(const NodePtr& node, int index, NodePtr& left, NodePtr& right) {
+        if (index <= 0) {
+            left = nullptr;
+            right = node;
+            return;
+        }
+        if (index >= length(node)) {
+            left = node;
+            right = nullptr;
+            return;
+        }
+
+        if (node->isLeaf()) {
+            const T* items = node->items.GetData();
+            left = makeLeaf(items, index);
+            right = makeLeaf(items + index, node->length - index);
+            return;
+        }
+
+        NodePtr splitLeft, splitRight;
+        if (index < length(node->left)) {
+            split(node->left, index, splitLeft, splitRight);
+            left = splitLeft;
+            right = join(splitRight, node->right);
+        } else {
+            split(node->right, index - length(node->left), splitLeft, splitRight);
+            left = join(node->left, splitLeft);
+            right = splitRight;
+        }
+    }
+
+    // Returns a tree in which the path to index is owned by this version alone, copying
+    // only the nodes that are still shared, and points slot at the element.
+    static NodePtr detach(const NodePtr& node, int index, bool unique, T*& slot) {
+        unique = unique && node.use_count() == 1;
+
+        if (node->isLeaf()) {
+            NodePtr owned = unique ? node : makeLeaf(DynamicArray<T>(node->items));
+            slot = const_cast<Node&>(*owned).items.GetData() + index;
+            return owned;
+        }
+
+        bool inLeft = index < length(node->left);
+        const NodePtr& child = inLeft ? node->left : node->right;
+        NodePtr detached = detach(child, inLeft ? index : index - length(node->left), unique, slot);
+
+        if (!unique) {
+            return inLeft ? makeNode(detached, node->right) : makeNode(node->left, detached);
+        }
+        if (detached != child) {
+            Node& owned = const_cast<Node&>(*node);
+            (inLeft ? owned.left : owned.right) = detached;
+        }
+        return node;
+    }
+
+    template <typename Visitor>
+    static bool forEachWhile(const NodePtr& node, Visitor& visit) {
+        if (!node) return true;
+
+        if (node->isLeaf()) {
+            const T* items = node->items.GetData();
+            for (int i = 0; i < node->length; ++i) {
+                if (!visit(items[i])) return false;
+            }
+            return true;
+        }
+        return forEachWhile(node->left, visit) && forEachWhile(node->right, visit);
+    }
+
+    // make_shared keeps the reference counts and a vtable pointer next to each node.
+    static constexpr std::size_t ControlBlockBytes = 2 * sizeof(long) + sizeof(void*);
+
+    static void addMemoryUsage(const NodePtr& node, MemoryUsage& usage) {
+        if (!node) return;
+
+        usage.overhead += ControlBlockBytes + sizeof(Node) - sizeof(node->items);
+        usage += node->items.GetMemoryUsage();
+        addMemoryUsage(node->left, usage);
+        addMemoryUsage(node->right, usage);
+    }
+
+public:
+    PersistentArray() : root(nullptr) {}
+
+    PersistentArray(const T* items, int count) : root(nullptr) {
+        if (count <= 0) return;
+
+        DynamicArray<NodePtr> leaves;
+        for (int i = 0; i < count; i += LeafCapacity) {
+            leaves.EmplaceBack(makeLeaf(items + i, std::min(LeafCapacity, count - i)));
+        }
+        root = build(leaves.GetData(), 0, leaves.GetSize());
+    }
+
+    // Chunks shared with other versions are counted in full here as well.
+    MemoryUsage GetMemoryUsage() const {
+        MemoryUsage usage;
+        usage.overhead = sizeof(*this);
+        addMemoryUsage(root, usage);
+        return usage;
+    }
+
+    int GetSize() const {
+        return length(root);
+    }
+
+    const T& Get(int index) const {
+        _checkException(index);
+
+        const Node* node = root.get();
+        while (!node->isLeaf()) {
+            if (index < node->left->length) {
+                node = node->left.get();
+            } else {
+                index -= node->left->length;
+                node = node->right.get();
+            }
+        }
+        return node->items.GetData()[index];
+    }
+
+    // Writable access for the owner of this version: shared nodes on the path are
+    // copied first, so other versions never observe the write. The reference is
+    // invalidated by any later update or copy of this array.
+    T& GetMutable(int index) {
+        _checkException(index);
+
+        T* slot = nullptr;
+        root = detach(root, index, true, slot);
+        return *slot;
+    }
+
+    PersistentArray<T> Set(const T& value, int index) const {
+        _checkException(index);
+        return PersistentArray<T>(set(root, index, value));
+    }
+
+    PersistentArray<T> InsertAt(const T& item, int index) const {
+        if (index < 0 || index > length(root)) {
+            throw std::out_of_range("Index out of range");
+        }
+        return PersistentArray<T>(insert(root, index, item));
+    }
+
+    PersistentArray<T> Append(const T& item) const {
+        return InsertAt(item, length(root));
+    }
+
+    PersistentArray<T> Prepend(const T& item) const {
+        return InsertAt(item, 0);
+    }
+
+    PersistentArray<T> RemoveAt(int index) const {
+        _checkException(index);
+        return PersistentArray<T>(remove(root, index));
+    }
+
+    PersistentArray<T> Concat(const PersistentArray<T>& other) const {
+        return PersistentArray<T>(join(root, other.root));
+    }
+
+    PersistentArray<T> GetSubArray(int startIndex, int endIndex) const {
+        _checkException(startIndex);
+        _checkException(endIndex);
+        if (startIndex > endIndex) {
+            throw std::invalid_argument("startIndex must not exceed endIndex");
+        }
+
+        NodePtr head, middle, tail, rest;
+        split(root, endIndex + 1, head, tail);
+        split(head, startIndex, rest, middle);
+        return PersistentArray<T>(middle);
+    }
+
+    template <typename Visitor>
+    void ForEach(Visitor visit) const {
+        auto visitAll = [&](const T& item) {
+            visit(item);
+            return true;
+        };
+        forEachWhile(root, visitAll);
+    }
+
+    template <typename Visitor>
+    bool ForEachWhile(Visitor visit) const {
+        return forEachWhile(root, visit);
+    }
+};
@@ -0,0 +1,668 @@
+#pragma once
+#include <stdexcept>
+#include <algorithm>
+#include "Sequence.hpp"
+
+
+// Rope of SegmentSequence leaves kept height-balanced like AVLTree. Internal nodes
+// are pure concatenations that store the length of their subtree, so positional
+// lookup, insert, remove, split and concat are all O(log n) (plus O(leafSize)
+// work inside a single leaf).
+template <typename T,
+    template<typename> class SegmentSequence = MutableArraySequence>
+class RopeSequence : public Sequence<T> {
+private:
+    static_assert(std::is_base_of_v<MutableSequenceTag, typename SegmentSequence<T>::tag>,
+        "SegmentSequence must be a mutable sequence type");
+
+    struct Node {
+        Node* left;
+        Node* right;
+        SegmentSequence<T>* segment;
+        int length;
+        int height;
+
+        Node(SegmentSequence<T>* segment_) :
+            left(nullptr), right(nullptr), segment(segment_), length(segment_->GetLength()), height(1) {}
+
+        Node(Node* left_, Node* right_) :
+            left(left_), right(right_), segment(nullptr),
+            length(left_->length + right_->length),
+            height(1 + std::max(left_->height, right_->height)) {}
+
+        ~Node() {
+            delete segment;
+        }
+
+        bool isLeaf() const {
+            return segment != nullptr;
+        }
+    };
+
+    Node* root;
+    int leafSize;
+
+    mutable Node* cursorLeaf;
+    mutable int cursorStart;
+
+    static int length(const Node* node) {
+        return node ? node->length : 0;
+    }
+
+    static int height(const Node* node) {
+        return node ? node->height : 0;
+    }
+
+    static void addMemoryUsage(const Node* node, MemoryUsage& usage) {
+        if (!node) return;
+
+        usage.overhead += sizeof(Node);
+        if (node->isLeaf()) {
+            usage += node->segment->GetMemoryUsage();
+        }
+        addMemoryUsage(node->left, usage);
+        addMemoryUsage(node->right, usage);
+    }
+
+    static int balanceFactor(const Node* node) {
+        return node ? height(node->left) - height(node->right) : 0;
+    }
+
+    static void updateNode(Node* node) {
+        if (node->isLeaf()) {
+            node->length = node->segment->GetLength();
+            return;
+        }
+
+        node->length = length(node->left) + length(node->right);
+        node->height = 1 + std::max(height(node->left), height(node->right));
+    }
+
+    static Node* rotateRight(Node* y) {
+        Node* x = y->left;
+        y->left = x->right;
+        x->right = y;
+
+        updateNode(y);
+        updateNode(x);
+        return x;
+    }
+
+    static Node* rotateLeft(Node* x) {
+        Node* y = x->right;
+        x->right = y->left;
+        y->left = x;
+
+        updateNode(x);
+        updateNode(y);
+        return y;
+    }
+
+    static Node* balance(Node* node) {
+        updateNode(node);
+        int bf = balanceFactor(node);
+
+        if (bf > 1) {
+            if (balanceFactor(node->left) < 0) {
+                node->left = rotateLeft(node->left);
+            }
+            return rotateRight(node);
+        }
+        if (bf < -1) {
+            if (balanceFactor(node->right) > 0) {
+                node->right = rotateRight(node->right);
+            }
+            return rotateLeft(node);
+        }
+
+        return node;
+    }
+
+    static Node* join(Node* left, Node* right) {
+        if (!left) return right;
+        if (!right) return left;
+
+        if (height(left) > height(right) + 1) {
+            left->right = join(left->right, right);
+            return balance(left);
+        }
+        if (height(right) > height(left) + 1) {
+            right->left = join(left, right->left);
+            return balance(right);
+        }
+
+        return new Node(left, right);
+    }
+
+    static SegmentSequence<T>* sliceSegment(const SegmentSequence<T>* source, int from, int to, int skip = -1) {
+        SegmentSequence<T>* result = new SegmentSequence<T>();
+        for (int i = from; i < to; ++i) {
+            if (i != skip) {
+                result->Append(source->Get(i));
+            }
+        }
+        return result;
+    }
+
+    static void insertIntoSegment(SegmentSequence<T>* segment, const T& item, int index) {
+        if (index == segment->GetLength()) {
+            segment->Append(item);
+        } else if (index == 0) {
+            segment->Prepend(item);
+        } else {
+            segment->InsertAt(item, index);
+        }
+    }
+
+    static void splitNode(Node* node, int index, Node*& left, Node*& right) {
+        if (!node) {
+            left = right = nullptr;
+            return;
+        }
+
+        if (node->isLeaf()) {
+            if (index <= 0) {
+                left = nullptr;
+                right = node;
+            } else if (index >= node->length) {
+                left = node;
+                right = nullptr;
+            } else {
+                left = new Node(sliceSegment(node->segment, 0, index));
+                right = new Node(sliceSegment(node->segment, index, node->length));
+                delete node;
+            }
+            return;
+        }
+
+        Node* nodeLeft = node->left;
+        Node* nodeRight = node->right;
+        node->left = node->right = nullptr;
+        delete node;
+
+        Node* rest = nullptr;
+        if (index < length(nodeLeft)) {
+            splitNode(nodeLeft, index, left, rest);
+            right = join(rest, nodeRight);
+        } else {
+            splitNode(nodeRight, index - length(nodeLeft), rest, right);
+            left = join(nodeLeft, rest);
+        }
+    }
+
+    Node* insertNode(Node* node, const T& item, int index) {
+        if (node->isLeaf()) {
+            SegmentSequence<T>* segment = node->segment;
+            int segmentLength = segment->GetLength();
+
+            if (segmentLength < leafSize) {
+                insertIntoSegment(segment, item, index);
+                updateNode(node);
+                return node;
+            }
+
+            SegmentSequence<T>* single = new SegmentSequence<T>();
+            single->Append(item);
+
+            if (index == segmentLength) return new Node(node, new Node(single));
+            if (index == 0) return new Node(new Node(single), node);
+            delete single;
+
+            int half = segmentLength / 2;
+            Node* left = new Node(sliceSegment(segment, 0, half));
+            Node* right = new Node(sliceSegment(segment, half, segmentLength));
+            delete node;
+
+            if (index <= half) {
+                insertIntoSegment(left->segment, item, index);
+                updateNode(left);
+            } else {
+                insertIntoSegment(right->segment, item, index - half);
+                updateNode(right);
+            }
+            return new Node(left, right);
+        }
+
+        if (index <= length(node->left)) {
+            node->left = insertNode(node->left, item, index);
+        } else {
+            node->right = insertNode(node->right, item, index - length(node->left));
+        }
+        return balance(node);
+    }
+
+    Node* removeNode(Node* node, int index) {
+        if (node->isLeaf()) {
+            if (node->length == 1) {
+                delete node;
+                return nullptr;
+            }
+
+            SegmentSequence<T>* segment = sliceSegment(node->segment, 0, node->length, index);
+            delete node->segment;
+            node->segment = segment;
+            updateNode(node);
+            return node;
+        }
+
+        bool leafPair = node->left->isLeaf() && node->right->isLeaf();
+
+        if (index < length(node->left)) {
+            node->left = removeNode(node->left, index);
+        } else {
+            node->right = removeNode(node->right, index - length(node->left));
+        }
+
+        if (!node->left || !node->right) {
+            Node* rest = node->left ? node->left : node->right;
+            node->left = node->right = nullptr;
+            delete node;
+            return rest;
+        }
+
+        // Only a pair of leaves is collapsed, so the subtree height drops by at most one.
+        if (leafPair && length(node->left) + length(node->right) <= leafSize) {
+            SegmentSequence<T>* segment = node->left->segment;
+            for (int i = 0; i < node->right->length; ++i) {
+                segment->Append(node->right->segment->Get(i));
+            }
+            node->left->segment = nullptr;
+            delete node->left;
+            delete node->right;
+            node->left = node->right = nullptr;
+            node->segment = segment;
+            node->height = 1;
+            updateNode(node);
+            return node;
+        }
+
+        return balance(node);
+    }
+
+    static Node* cloneNode(const Node* node) {
+        if (!node) return nullptr;
+        if (node->isLeaf()) return new Node(sliceSegment(node->segment, 0, node->length));
+
+        return new Node(cloneNode(node->left), cloneNode(node->right));
+    }
+
+    template <typename Visitor>
+    static bool forEachLeaf(const Node* node, Visitor& visit) {
+        if (!node) return true;
+        if (node->isLeaf()) {
+            return node->segment->ForEachWhile(visit);
+        }
+
+        return forEachLeaf(node->left, visit) && forEachLeaf(node->right, visit);
+    }
+
+    static void clear(Node* node) {
+        if (!node) return;
+
+        clear(node->left);
+        clear(node->right);
+        delete node;
+    }
+
+    Node* findLeaf(int index, int& offset) const {
+        if (index < 0 || index >= length(root)) {
+            throw std::out_of_range("Index out of range");
+        }
+
+        if (cursorLeaf && index >= cursorStart && index < cursorStart + cursorLeaf->length) {
+            offset = index - cursorStart;
+            return cursorLeaf;
+        }
+
+        Node* node = root;
+        int start = 0;
+        while (!node->isLeaf()) {
+            if (index - start < length(node->left)) {
+                node = node->left;
+            } else {
+                start += length(node->left);
+                node = node->right;
+            }
+        }
+
+        cursorLeaf = node;
+        cursorStart = start;
+        offset = index - start;
+        return node;
+    }
+
+    virtual Sequence<T>* AppendInternal(const T& item) override {
+        return InsertAtInternal(item, length(root));
+    }
+
+    virtual Sequence<T>* PrependInternal(const T& item) override {
+        return InsertAtInternal(item, 0);
+    }
+
+    virtual Sequence<T>* InsertAtInternal(const T& item, int index) override {
+        if (index < 0 || index > length(root)) {
+            throw std::out_of_range("Index out of range");
+        }
+
+        cursorLeaf = nullptr;
+        if (!root) {
+            SegmentSequence<T>* segment = new SegmentSequence<T>();
+            segment->Append(item);
+            root = new Node(segment);
+            return this;
+        }
+
+        root = insertNode(root, item, index);
+        return this;
+    }
+
+    virtual Sequence<T>* ConcatInternal(const Sequence<T>* other) override {
+        const RopeSequence<T, SegmentSequence>* rope = dynamic_cast<const RopeSequence<T, SegmentSequence>*>(other);
+        if (rope) {
+            cursorLeaf = nullptr;
+            root = join(root, cloneNode(rope->root));
+            return this;
+        }
+
+        for (int i = 0; i < other->GetLength(); ++i) {
+            this->AppendInternal(other->Get(i));
+        }
+        return this;
+    }
+
+    virtual Sequence<T>* RemoveAtInternal(int index) override {
+        if (index < 0 || index >= length(root)) {
+            throw std::out_of_range("Index out of range");
+        }
+
+        cursorLeaf = nullptr;
+        root = removeNode(root, index);
+        return this;
+    }
+
+protected:
+    virtual RopeSequence<T, SegmentSequence>* Instance() = 0;
+    virtual RopeSequence<T, SegmentSequence>* CreateEmptyRopeSequence() const = 0;
+
+    virtual bool ForEachInternal(const std::function<bool(const T&)>& visit) const override {
+        return ForEachWhile(visit);
+    }
+
+    void splitOff(int index, RopeSequence<T, SegmentSequence>& tail) {
+        if (index < 0 || index > length(root)) {
+            throw std::out_of_range("Index out of range");
+        }
+
+        Node* left = nullptr;
+        Node* right = nullptr;
+        splitNode(root, index, left, right);
+
+        clear(tail.root);
+        root = left;
+        tail.root = right;
+        cursorLeaf = tail.cursorLeaf = nullptr;
+    }
+
+    void joinWith(RopeSequence<T, SegmentSequence>& other) {
+        if (this == &other) return;
+
+        root = join(root, other.root);
+        other.root = nullptr;
+        cursorLeaf = other.cursorLeaf = nullptr;
+    }
+
+public:
+    explicit RopeSequence(int leafSize_ = 64) :
+        root(nullptr),
+        leafSize(leafSize_),
+        cursorLeaf(nullptr),
+        cursorStart(0) {
+        if (leafSize_ <= 0) {
+            throw std::invalid_argument("Leaf size must be positive");
+        }
+    }
+
+    RopeSequence(const T* items, int count, int leafSize_ = 64) : RopeSequence(leafSize_) {
+        for (int i = 0; i < count; ++i) {
+            AppendInternal(items[i]);
+        }
+    }
+
+    RopeSequence(const Sequence<T>& other, int leafSize_ = 64) : RopeSequence(leafSize_) {
+        for (int i = 0; i < other.GetLength(); ++i) {
+            AppendInternal(other.Get(i));
+        }
+    }
+
+    RopeSequence(const RopeSequence& other) :
+        root(cloneNode(other.root)),
+        leafSize(other.leafSize),
+        cursorLeaf(nullptr),
+        cursorStart(0) {}
+
+    RopeSequence(RopeSequence&& other) noexcept :
+        root(other.root),
+        leafSize(other.leafSize),
+        cursorLeaf(nullptr),
+        cursorStart(0) {
+        other.root = nullptr;
+        other.cursorLeaf = nullptr;
+    }
+
+    RopeSequence<T, SegmentSequence>& operator=(const RopeSequence& other) {
+        if (this != &other) {
+            clear(root);
+            root = cloneNode(other.root);
+            leafSize = other.leafSize;
+            cursorLeaf = nullptr;
+        }
+        return *this;
+    }
+
+    RopeSequence<T, SegmentSequence>& operator=(RopeSequence&& other) noexcept {
+        if (this != &other) {
+            clear(root);
+            root = other.root;
+            leafSize = other.leafSize;
+            cursorLeaf = nullptr;
+
+            other.root = nullptr;
+            other.cursorLeaf = nullptr;
+        }
+        return *this;
+    }
+
+    ~RopeSequence() override {
+        clear(root);
+    }
+
+    virtual Sequence<T>* GetSubsequence(int startIndex, int endIndex) const override {
+        if (std::min(startIndex, endIndex) < 0 || std::max(startIndex, endIndex) >= length(root)) {
+            throw std::out_of_range("Invalid subsequence range");
+        }
+
+        RopeSequence<T, SegmentSequence>* result = this->CreateEmptyRopeSequence();
+        for (int i = std::min(startIndex, endIndex); i <= std::max(startIndex, endIndex); ++i) {
+            if (startIndex <= endIndex) {
+                result->AppendInternal(this->Get(i));
+            } else {
+                result->PrependInternal(this->Get(i));
+            }
+        }
+
+        return result;
+    }
+
+    virtual T& operator[] (int index) override {
+        return this->Get(index);
+    }
+
+    virtual const T& GetFirst() const override {
+        if (!root) throw std::out_of_range("Sequence is empty");
+
+        return this->Get(0);
+    }
+
+    virtual const T& GetLast() const override {
+        if (!root) throw std::out_of_range("Sequence is empty");
+
+        return this->Get(length(root) - 1);
+    }
+
+    virtual const T& Get(int index) const override {
+        int offset = 0;
+        Node* leaf = findLeaf(index, offset);
+        return leaf->segment->Get(offset);
+    }
+
+    virtual T& GetFirst() override {
+        if (!root) throw std::out_of_range("Sequence is empty");
+
+        return this->Get(0);
+    }
+
+    virtual T& GetLast() override {
+        if (!root) throw std::out_of_range("Sequence is empty");
+
+        return this->Get(length(root) - 1);
+    }
+
+    virtual T& Get(int index) override {
+        int offset = 0;
+        Node* leaf = findLeaf(index, offset);
+        return leaf->segment->Get(offset);
+    }
+
+    virtual int GetLength() const override {
+        return length(root);
+    }
+
+    virtual MemoryUsage GetMemoryUsage() const override {
+        MemoryUsage usage;
+        usage.overhead = sizeof(*this);
+        addMemoryUsage(root, usage);
+        return usage;
+    }
+
+    int GetLeafSize() const {
+        return leafSize;
+    }
+
+    template <typename Visitor>
+    void ForEach(Visitor visit) const {
+        auto visitAll = [&](const T& item) {
+            visit(item);
+            return true;
+        };
+        forEachLeaf(root, visitAll);
+    }
+
+    template <typename Visitor>
+    bool ForEachWhile(Visitor visit) const {
+        return forEachLeaf(root, visit);
+    }
+
+    virtual Sequence<T>* Append(const T& item) override {
+        return this->Instance()->AppendInternal(item);
+    }
+
+    virtual Sequence<T>* Prepend(const T& item) override {
+        return this->Instance()->PrependInternal(item);
+    }
+
+    virtual Sequence<T>* InsertAt(const T& item, int index) override {
+        return this->Instance()->InsertAtInternal(item, index);
+    }
+
+    virtual Sequence<T>* Concat(const Sequence<T>* other) override {
+        return this->Instance()->ConcatInternal(other);
+    }
+
+    virtual Sequence<T>* RemoveAt(int index) override {
+        return this->Instance()->RemoveAtInternal(index);
+    }
+};
+
+template <typename T,
+          template<typename> class SegmentSequence = MutableArraySequence>
+class MutableRopeSequence : public RopeSequence<T, SegmentSequence> {
+public:
+    using tag = MutableSequenceTag;
+
+    explicit MutableRopeSequence(int leafSize = 64) :
+        RopeSequence<T, SegmentSequence>(leafSize) {}
+
+    MutableRopeSequence(const T* items, int count, int leafSize = 64) :
+        RopeSequence<T, SegmentSequence>(items, count, leafSize) {}
+
+    MutableRopeSequence(const Sequence<T>& other, int leafSize = 64) :
+        RopeSequence<T, SegmentSequence>(other, leafSize) {}
+
+    MutableRopeSequence(MutableRopeSequence&& other) noexcept :
+        RopeSequence<T, SegmentSequence>(std::move(other)) {}
+
+    MutableRopeSequence(const MutableRopeSequence& other) :
+        RopeSequence<T, SegmentSequence>(other) {}
+
+    virtual RopeSequence<T, SegmentSequence>* Instance() override {
+        return this;
+    }
+
+    virtual Sequence<T>* CreateEmptySequence() const override {
+        return new MutableRopeSequence<T, SegmentSequence>(this->GetLeafSize());
+    }
+
+    virtual RopeSequence<T, SegmentSequence>* CreateEmptyRopeSequence() const override {
+        return new MutableRopeSequence<T, SegmentSequence>(this->GetLeafSize());
+    }
+
+    MutableRopeSequence<T, SegmentSequence>* SplitAt(int index) {
+        MutableRopeSequence<T, SegmentSequence>* tail = new MutableRopeSequence<T, SegmentSequence>(this->GetLeafSize());
+        this->splitOff(index, *tail);
+        return tail;
+    }
+
+    void Join(MutableRopeSequence<T, SegmentSequence>& other) {
+        this->joinWith(other);
+    }
+};
+
+
+template <typename T,
+          template<typename> class SegmentSequence = MutableArraySequence>
+class ImmutableRopeSequence : public RopeSequence<T, SegmentSequence> {
+private:
+    RopeSequence<T, SegmentSequence>* Clone() const {
+        return new ImmutableRopeSequence<T, SegmentSequence>(*this);
+    }
+
+public:
+    using tag = ImmutableSequenceTag;
+
+    explicit ImmutableRopeSequence(int leafSize = 64) :
+        RopeSequence<T, SegmentSequence>(leafSize) {}
+
+    ImmutableRopeSequence(const T* items, int count, int leafSize = 64) :
+        RopeSequence<T, SegmentSequence>(items, count, leafSize) {}
+
+    ImmutableRopeSequence(const Sequence<T>& other, int leafSize = 64) :
+        RopeSequence<T, SegmentSequence>(other, leafSize) {}
+
+    ImmutableRopeSequence(ImmutableRopeSequence&& other) noexcept :
+        RopeSequence<T, SegmentSequence>(std::move(other)) {}
+
+    ImmutableRopeSequence(const ImmutableRopeSequence& other) :
+        RopeSequence<T, SegmentSequence>(other) {}
+
+    virtual RopeSequence<T, SegmentSequence>* Instance() override {
+        return Clone();
+    }
+
+    virtual Sequence<T>* CreateEmptySequence() const override {
+        return new ImmutableRopeSequence<T, SegmentSequence>(this->GetLeafSize());
+    }
+
+    virtual RopeSequence<T, SegmentSequence>* CreateEmptyRopeSequence() const override {
+        return new ImmutableRopeSequence<T, SegmentSequence>(this->GetLeafSize());
+    }
+};
\ No newline at end of file
@@ -1,6 +1,8 @@
 #pragma once
 #include <stdexcept>
+#include <algorithm>
 #include "Sequence.hpp"
+#include "FenwickTree.hpp"
 
 
 template <typename T, 
@@ -18,6 +20,19 @@ private:
     int segmentSize;
     int totalSize;
 
+    static constexpr int MinIndexFront = 8;
+
+    // Prefix sums of segment lengths, rebuilt lazily after segments are inserted mid-container.
+    // Segment i lives in slot indexFront + i; the empty slots in front absorb new first
+    // segments from Prepend without a rebuild.
+    mutable FenwickTree lengthIndex;
+    mutable bool indexDirty;
+    mutable int indexFront;
+
+    // Last segment hit by getSegmentAndOffset, so sequential access does not search the index.
+    mutable int cursorSegment;
+    mutable int cursorStart;
+
     void ensureCapacity(int requiredCapacity) {
         int requiredSegments = (requiredCapacity + segmentSize - 1) / segmentSize;
         while (this->segments->GetLength() < requiredSegments) {
@@ -25,10 +40,94 @@ private:
         }
     }
 
-    SegmentSequence<T>* createSegment() {
+    static SegmentSequence<T>* createSegment() {
         return new SegmentSequence<T>();
     }
 
+    static void deleteSegments(DynamicArray<SegmentSequence<T>*>& built) {
+        for (int i = 0; i < built.GetSize(); ++i) {
+            delete built[i];
+        }
+    }
+
+    // Segment pointers in order, gathered in one walk so parallel tasks can index them
+    // directly; ContainerSequence::Get is O(i) when the directory is a list.
+    DynamicArray<SegmentSequence<T>*> segmentTable() const {
+        DynamicArray<SegmentSequence<T>*> table;
+        table.Reserve(segments->GetLength());
+        segments->ForEach([&table](SegmentSequence<T>* segment) {
+            table.EmplaceBack(segment);
+        });
+        return table;
+    }
+
+    void deleteAllSegments() {
+        segments->ForEach([](SegmentSequence<T>* segment) {
+            delete segment;
+        });
+    }
+
+    void copySegmentsFrom(const SegmentedSequence& other) {
+        other.segments->ForEach([this](const SegmentSequence<T>* segment) {
+            segments->Append(static_cast<SegmentSequence<T>*>(segment->GetSubsequence(0, segment->GetLength() - 1)));
+        });
+    }
+
+    int segmentGrain() const {
+        return std::max(1, ThreadPool::DefaultGrain / segmentSize);
+    }
+
+    void invalidateIndex() {
+        indexDirty = true;
+        cursorSegment = -1;
+    }
+
+    void rebuildIndex() const {
+        DynamicArray<int> lengths;
+        lengths.Reserve(segments->GetLength());
+        segments->ForEach([&lengths](const SegmentSequence<T>* segment) {
+            lengths.EmplaceBack(segment->GetLength());
+        });
+
+        int count = lengths.GetSize();
+        indexFront = std::max(MinIndexFront, count);
+        lengthIndex.Build(indexFront + count, [&](int i) {
+            return i < indexFront ? 0 : lengths[i - indexFront];
+        });
+        indexDirty = false;
+    }
+
+    void segmentResized(int segmentIndex, int delta) {
+        if (!indexDirty) {
+            lengthIndex.Add(indexFront + segmentIndex, delta);
+        }
+        if (cursorSegment > segmentIndex) {
+            cursorSegment = -1;
+        }
+    }
+
+    void segmentAppended() {
+        if (!indexDirty) {
+            lengthIndex.Append(this->segments->GetLast()->GetLength());
+        }
+    }
+
+    // The new first segment takes the slot in front of the old one while any are left.
+    void segmentPrepended() {
+        cursorSegment = -1;
+        if (indexDirty) return;
+
+        if (indexFront == 0) {
+            invalidateIndex();
+            return;
+        }
+        --indexFront;
+        int length = this->segments->GetFirst()->GetLength();
+        if (length != 0) {
+            lengthIndex.Add(indexFront, length);
+        }
+    }
+
     void splitSegment(int segmentIndex, int splitPos = -1) {
         if (segmentIndex < 0 || segmentIndex >= segments->GetLength()) {
             throw std::out_of_range("Invalid segment index");
@@ -53,39 +152,64 @@ private:
         segments->Get(segmentIndex) = firstPart;
         if (segmentIndex + 1 == segments->GetLength()) {
             segments->Append(newSegment);
+            segmentResized(segmentIndex, -newSegment->GetLength());
+            segmentAppended();
         } else {
             segments->InsertAt(newSegment, segmentIndex + 1);
+            invalidateIndex();
         }
         
         delete oldSegment;
     }
 
-    virtual Sequence<T>* AppendInternal(const T& item) override {
-        if (this->segments->GetLength() == 0) {
-            this->segments->Append(createSegment());
+    void removeSegment(int segmentIndex) {
+        delete segments->Get(segmentIndex);
+        segments->RemoveAt(segmentIndex);
+        invalidateIndex();
+    }
+
+    void mergeUnderfull(int segmentIndex) {
+        int length = segments->Get(segmentIndex)->GetLength();
+        if (length * 2 >= segmentSize) return;
+
+        int target = -1;
+        if (segmentIndex + 1 < segments->GetLength() &&
+            length + segments->Get(segmentIndex + 1)->GetLength() <= segmentSize) {
+            target = segmentIndex;
+        } else if (segmentIndex > 0 &&
+            length + segments->Get(segmentIndex - 1)->GetLength() <= segmentSize) {
+            target = segmentIndex - 1;
         }
+        if (target == -1) return;
 
-        if (this->segments->GetLast()->GetLength() >= segmentSize) {
-            splitSegment(this->GetSegmentsLength() - 1);
-            return AppendInternal(item);
+        SegmentSequence<T>* destination = segments->Get(target);
+        SegmentSequence<T>* source = segments->Get(target + 1);
+        for (const T& item : *source) {
+            destination->Append(item);
+        }
+        removeSegment(target + 1);
+    }
+
+    virtual Sequence<T>* AppendInternal(const T& item) override {
+        if (this->segments->GetLength() == 0 || this->segments->GetLast()->GetLength() >= segmentSize) {
+            this->segments->Append(createSegment());
+            segmentAppended();
         }
 
         this->segments->GetLast()->Append(item);
+        segmentResized(this->segments->GetLength() - 1, 1);
         totalSize++;
         return this;
     }
 
     virtual Sequence<T>* PrependInternal(const T& item) override {
-        if (this->segments->GetLength() == 0) {
+        if (this->segments->GetLength() == 0 || this->segments->GetFirst()->GetLength() >= segmentSize) {
             segments->Prepend(createSegment());
-        }
-
-        if (this->segments->GetFirst()->GetLength() >= segmentSize) {
-            splitSegment(0);
-            return PrependInternal(item);
+            segmentPrepended();
         }
 
         this->segments->GetFirst()->Prepend(item);
+        segmentResized(0, 1);
         totalSize++;
         return this;
     }
@@ -102,8 +226,24 @@ private:
             return PrependInternal(item);
         }
     
-        auto [segment, segmentIndex, localIndex] = getSegmentAndOffset(globalIndex, 1);
+        auto [segment, segmentIndex, localIndex] = getSegmentAndOffset(globalIndex);
+        if (localIndex == 0 && segmentIndex > 0 && segments->Get(segmentIndex - 1)->GetLength() < segmentSize) {
+            segments->Get(segmentIndex - 1)->Append(item);
+            segmentResized(segmentIndex - 1, 1);
+            totalSize++;
+            return this;
+        }
+
         if (segment->GetLength() >= segmentSize) {
+            if (localIndex == 0) {
+                SegmentSequence<T>* newSegment = createSegment();
+                newSegment->Append(item);
+                segments->InsertAt(newSegment, segmentIndex);
+                invalidateIndex();
+                totalSize++;
+                return this;
+            }
+
             splitSegment(segmentIndex);
             return InsertAtInternal(item, globalIndex);
         }
@@ -116,44 +256,173 @@ private:
             segment->InsertAt(item, localIndex);
         }
 
+        segmentResized(segmentIndex, 1);
         totalSize++;
         return this;
     }
 
     virtual Sequence<T>*ConcatInternal(const Sequence<T>* other) override {
-        for (int i = 0; i < other->GetLength(); ++i) {
-            this->Append(other->Get(i));
+        if (other == this) {
+            if (totalSize == 0) return this;
+            std::unique_ptr<Sequence<T>> copy(GetSubsequence(0, totalSize - 1));
+            return ConcatInternal(copy.get());
+        }
+
+        other->ForEach([this](const T& item) {
+            AppendInternal(item);
+        });
+        return this;
+    }
+
+    virtual Sequence<T>* RemoveAtInternal(int globalIndex) override {
+        auto [segment, segmentIndex, localIndex] = getSegmentAndOffset(globalIndex);
+
+        segment->RemoveAt(localIndex);
+        totalSize--;
+
+        if (segment->GetLength() == 0) {
+            removeSegment(segmentIndex);
+        } else {
+            segmentResized(segmentIndex, -1);
+            mergeUnderfull(segmentIndex);
+        }
+        return this;
+    }
+
+    Sequence<T>* CompactInternal() {
+        auto* packed = new ContainerSequence<SegmentSequence<T>*>();
+        SegmentSequence<T>* current = nullptr;
+
+        segments->ForEach([&](SegmentSequence<T>* segment) {
+            for (const T& item : *segment) {
+                if (!current || current->GetLength() >= segmentSize) {
+                    current = createSegment();
+                    packed->Append(current);
+                }
+                current->Append(item);
+            }
+            delete segment;
+        });
+
+        delete segments;
+        segments = packed;
+        invalidateIndex();
+        return this;
+    }
+
+    Sequence<T>* RemoveRangeInternal(int startIndex, int endIndex) {
+        auto* kept = new ContainerSequence<SegmentSequence<T>*>();
+        int firstPartial = -1;
+        int lastPartial = -1;
+        int start = 0;
+
+        segments->ForEach([&](SegmentSequence<T>* segment) {
+            int end = start + segment->GetLength();
+
+            if (end <= startIndex || start > endIndex) {
+                kept->Append(segment);
+            } else if (startIndex <= start && end - 1 <= endIndex) {
+                delete segment;
+            } else {
+                SegmentSequence<T>* rest = createSegment();
+                int position = start;
+                segment->ForEach([&](const T& item) {
+                    if (position < startIndex || position > endIndex) {
+                        rest->Append(item);
+                    }
+                    ++position;
+                });
+                delete segment;
+
+                kept->Append(rest);
+                if (firstPartial == -1) firstPartial = kept->GetLength() - 1;
+                lastPartial = kept->GetLength() - 1;
+            }
+            start = end;
+        });
+
+        delete segments;
+        segments = kept;
+        totalSize -= endIndex - startIndex + 1;
+        invalidateIndex();
+
+        if (lastPartial != -1) {
+            mergeUnderfull(lastPartial);
+            if (firstPartial != lastPartial) mergeUnderfull(firstPartial);
         }
         return this;
     }
 
 protected:
-    virtual Sequence<T>* Instance() = 0;
+    virtual SegmentedSequence<T, SegmentSequence, ContainerSequence>* Instance() = 0;
     virtual SegmentedSequence<T, SegmentSequence, ContainerSequence>* CreateEmptySegSequence() const = 0;
 
-    std::tuple<SegmentSequence<T>*, int, int> getSegmentAndOffset(int index, bool isAdded=0) const {
+    virtual bool ForEachInternal(const std::function<bool(const T&)>& visit) const override {
+        return ForEachWhile(visit);
+    }
+
+    // Appends a segment built by Map/Where to a result that was created empty.
+    void adoptSegment(SegmentSequence<T>* segment) {
+        if (segment->GetLength() == 0) {
+            delete segment;
+            return;
+        }
+
+        segments->Append(segment);
+        totalSize += segment->GetLength();
+        segmentAppended();
+    }
+
+    std::tuple<SegmentSequence<T>*, int, int> getSegmentAndOffset(int index) const {
         if (index < 0 || index >= totalSize || segments->GetLength() == 0) {
             throw std::out_of_range("Index out of range");
         }
-    
-        int ind = 0;
-        while (ind < segments->GetLength() && index >= segments->Get(ind)->GetLength() + isAdded) {
-            index -= segments->Get(ind)->GetLength();
-            ++ind;
+
+        if (cursorSegment >= 0) {
+            SegmentSequence<T>* segment = segments->Get(cursorSegment);
+            int segmentEnd = cursorStart + segment->GetLength();
+
+            if (index >= cursorStart && index < segmentEnd) {
+                return std::make_tuple(segment, cursorSegment, index - cursorStart);
+            }
+
+            if (index >= segmentEnd && cursorSegment + 1 < segments->GetLength()) {
+                SegmentSequence<T>* next = segments->Get(cursorSegment + 1);
+                if (index < segmentEnd + next->GetLength()) {
+                    ++cursorSegment;
+                    cursorStart = segmentEnd;
+                    return std::make_tuple(next, cursorSegment, index - cursorStart);
+                }
+            }
         }
-    
-        if (ind >= segments->GetLength()) {
+
+        if (indexDirty) {
+            rebuildIndex();
+        }
+
+        int offset = 0;
+        int ind = lengthIndex.Find(index, offset) - indexFront;
+        if (ind < 0 || ind >= segments->GetLength()) {
             throw std::out_of_range("Index out of range");
         }
-    
-        return std::make_tuple(segments->Get(ind), ind, index);
+
+        cursorSegment = ind;
+        cursorStart = index - offset;
+        return std::make_tuple(segments->Get(ind), ind, offset);
     }
 
 public:
+    using SegmentType = SegmentSequence<T>;
+
     explicit SegmentedSequence(int segmentSize_) :
         segments(new ContainerSequence<SegmentSequence<T>*>()),
         segmentSize(segmentSize_),
-        totalSize(0) {
+        totalSize(0),
+        lengthIndex(),
+        indexDirty(false),
+        indexFront(0),
+        cursorSegment(-1),
+        cursorStart(0) {
         if (segmentSize_ <= 0) {
             throw std::invalid_argument("Segment size must be positive");
         }
@@ -162,7 +431,12 @@ public:
     SegmentedSequence(const T* items, int count, int segmentSize_ = 10) : 
     segments(new ContainerSequence<SegmentSequence<T>*>()),
     segmentSize(segmentSize_),
-    totalSize(0)
+    totalSize(0),
+    lengthIndex(),
+    indexDirty(false),
+    indexFront(0),
+    cursorSegment(-1),
+    cursorStart(0)
     {
         if (segmentSize_ <= 0) throw std::invalid_argument("Segment size must be positive");
 
@@ -172,33 +446,45 @@ public:
     }
 
     SegmentedSequence(const Sequence<T>& other, int segmentSize_ = 10) : 
-    segments(new ContainerSequence<Sequence<T>*>()),
+    segments(new ContainerSequence<SegmentSequence<T>*>()),
     segmentSize(segmentSize_),
-    totalSize(0)
+    totalSize(0),
+    lengthIndex(),
+    indexDirty(false),
+    indexFront(0),
+    cursorSegment(-1),
+    cursorStart(0)
     {
         if (segmentSize_ <= 0) throw std::invalid_argument("Segment size must be positive");
 
-        for (int i = 0; i < other.GetLength(); ++i) {
-            AppendInternal(other.Get(i));
-        }
+        other.ForEach([this](const T& item) {
+            AppendInternal(item);
+        });
     }
 
     SegmentedSequence(const SegmentedSequence& other) : 
     segments(new ContainerSequence<SegmentSequence<T>*>()),
     segmentSize(other.segmentSize),
-    totalSize(0)
+    totalSize(0),
+    lengthIndex(),
+    indexDirty(true),
+    indexFront(0),
+    cursorSegment(-1),
+    cursorStart(0)
     {
-        for (int i = 0; i < other.segments->GetLength(); ++i) {
-            SegmentSequence<T>* newSegment = static_cast<SegmentSequence<T>*>(other.segments->Get(i)->GetSubsequence(0, other.segments->Get(i)->GetLength()-1));
-            segments->Append(newSegment);
-        }
+        copySegmentsFrom(other);
         totalSize = other.totalSize;
     }
 
     SegmentedSequence(SegmentedSequence&& other) noexcept :
     segments(other.segments),
     segmentSize(other.segmentSize),
-    totalSize(other.totalSize)
+    totalSize(other.totalSize),
+    lengthIndex(std::move(other.lengthIndex)),
+    indexDirty(other.indexDirty),
+    indexFront(other.indexFront),
+    cursorSegment(-1),
+    cursorStart(0)
     {
         other.segments = nullptr;
         other.totalSize = 0;
@@ -206,34 +492,36 @@ public:
 
     SegmentedSequence<T, SegmentSequence, ContainerSequence>& operator=(const SegmentedSequence& other) {
         if (this != &other) {
-            for (int i = 0; i < segments->GetLength(); ++i) {
-                delete segments->Get(i);
+            if (segments) {
+                deleteAllSegments();
+                delete segments;
             }
-            delete segments;
 
-            segments = new ContainerSequence<Sequence<T>*>();
+            segments = new ContainerSequence<SegmentSequence<T>*>();
             segmentSize = other.segmentSize;
             totalSize = 0;
 
-            for (int i = 0; i < other.segments->GetLength(); ++i) {
-                Sequence<T>* newSegment = other.segments->Get(i)->GetSubsequence(0, other.segments->Get(i)->GetLength()-1);
-                segments->Append(newSegment);
-            }
+            copySegmentsFrom(other);
             totalSize = other.totalSize;
+            invalidateIndex();
         }
         return *this;
     }
 
     SegmentedSequence<T, SegmentSequence, ContainerSequence>& operator=(SegmentedSequence&& other) {
         if (this != &other) {
-            for (int i = 0; i < segments->GetLength(); ++i) {
-                delete segments->Get(i);
+            if (segments) {
+                deleteAllSegments();
+                delete segments;
             }
-            delete segments;
 
             segments = other.segments;
             segmentSize = other.segmentSize;
             totalSize = other.totalSize;
+            lengthIndex = std::move(other.lengthIndex);
+            indexDirty = other.indexDirty;
+            indexFront = other.indexFront;
+            cursorSegment = -1;
 
             other.segments = nullptr;
             other.totalSize = 0;
@@ -242,9 +530,9 @@ public:
     }
 
     ~SegmentedSequence() override {
-        for (int i = 0; i < this->segments->GetLength(); ++i) {
-            delete this->segments->Get(i);
-        }
+        if (!this->segments) return;
+
+        deleteAllSegments();
         delete this->segments;
     }
 
@@ -254,13 +542,28 @@ public:
         }
 
         auto* result = this->CreateEmptySegSequence();
-        for (int i = std::min(startIndex, endIndex); i <= std::max(startIndex, endIndex); ++i) {
-            if (startIndex < endIndex) {
-                result->Append(this->Get(i));
-            } else {
-                result->Prepend(this->Get(i));
+        int first = std::min(startIndex, endIndex);
+        int last = std::max(startIndex, endIndex);
+        int start = 0;
+        // Whole segments before the range are skipped by length alone.
+        segments->ForEachWhile([&](const SegmentSequence<T>* segment) {
+            int end = start + segment->GetLength();
+            if (end > first) {
+                int position = start;
+                segment->ForEachWhile([&](const T& item) {
+                    if (position >= first) {
+                        if (startIndex < endIndex) {
+                            result->AppendInternal(item);
+                        } else {
+                            result->PrependInternal(item);
+                        }
+                    }
+                    return ++position <= last;
+                });
             }
-        }
+            start = end;
+            return start <= last;
+        });
 
         return result;
     }
@@ -311,6 +614,183 @@ public:
         return totalSize;
     }
 
+    virtual MemoryUsage GetMemoryUsage() const override {
+        // The segment pointers are bookkeeping, not elements.
+        MemoryUsage directory = segments->GetMemoryUsage();
+        MemoryUsage usage;
+        usage.overhead = sizeof(*this) - sizeof(lengthIndex) + directory.payload + directory.overhead;
+        usage.slack = directory.slack;
+        usage += lengthIndex.GetMemoryUsage();
+        // One walk of the directory: Get(i) is O(i) when it is a list.
+        segments->ForEach([&usage](const SegmentSequence<T>* segment) {
+            usage += segment->GetMemoryUsage();
+        });
+        return usage;
+    }
+
+    // Elements held per segment slot, from 0 to 1. Values well below 1 mean many
+    // half-empty segments, which Compact() folds back together.
+    double GetSegmentFill() const {
+        int count = segments->GetLength();
+        return count > 0 ? static_cast<double>(totalSize) / (static_cast<double>(count) * segmentSize) : 1.0;
+    }
+
+    template <typename Visitor>
+    void ForEach(Visitor visit) const {
+        segments->ForEach([&visit](const SegmentSequence<T>* segment) {
+            segment->ForEach(visit);
+        });
+    }
+
+    template <typename Visitor>
+    bool ForEachWhile(Visitor visit) const {
+        return segments->ForEachWhile([&visit](const SegmentSequence<T>* segment) {
+            return segment->ForEachWhile(visit);
+        });
+    }
+
+    template <typename Mapper>
+    SegmentedSequence<T, SegmentSequence, ContainerSequence>* Map(Mapper mapper) const {
+        auto* result = this->CreateEmptySegSequence();
+        int index = 0;
+
+        segments->ForEach([&](const SegmentSequence<T>* segment) {
+            SegmentSequence<T>* mapped = createSegment();
+            mapped->Reserve(segment->GetLength());
+
+            segment->ForEach([&](const T& item) {
+                mapped->Append(Sequence<T>::ApplyMapper(mapper, item, index++));
+            });
+            result->adoptSegment(mapped);
+        });
+        return result;
+    }
+
+    template <typename Predicate>
+    SegmentedSequence<T, SegmentSequence, ContainerSequence>* Where(Predicate wherer) const {
+        auto* result = this->CreateEmptySegSequence();
+
+        segments->ForEach([&](const SegmentSequence<T>* segment) {
+            SegmentSequence<T>* kept = createSegment();
+            segment->ForEach([&](const T& item) {
+                if (wherer(item)) {
+                    kept->Append(item);
+                }
+            });
+            result->adoptSegment(kept);
+        });
+        return result;
+    }
+
+    template <typename Reducer>
+    T Reduce(Reducer reducer, const T& startVal) const {
+        T accumulator = startVal;
+        ForEach([&](const T& item) {
+            accumulator = reducer(accumulator, item);
+        });
+        return accumulator;
+    }
+
+    // Parallel algorithms use whole segments as task units. The callables are invoked
+    // concurrently and must be safe to call from several threads.
+    template <typename Mapper>
+    SegmentedSequence<T, SegmentSequence, ContainerSequence>* ParallelMap(Mapper mapper,
+        ThreadPool& pool = ThreadPool::Shared()) const {
+        DynamicArray<SegmentSequence<T>*> table = segmentTable();
+        int count = table.GetSize();
+        DynamicArray<int> starts(count);
+        DynamicArray<SegmentSequence<T>*> mapped(count);
+
+        for (int i = 1; i < count; ++i) {
+            starts[i] = starts[i - 1] + table[i - 1]->GetLength();
+        }
+
+        try {
+            pool.ParallelForRange(count, segmentGrain(), [&](int begin, int end) {
+                for (int i = begin; i < end; ++i) {
+                    const SegmentSequence<T>* segment = table[i];
+                    int index = starts[i];
+
+                    mapped[i] = createSegment();
+                    mapped[i]->Reserve(segment->GetLength());
+                    segment->ForEach([&](const T& item) {
+                        mapped[i]->Append(Sequence<T>::ApplyMapper(mapper, item, index++));
+                    });
+                }
+            });
+        } catch (...) {
+            deleteSegments(mapped);
+            throw;
+        }
+
+        auto* result = this->CreateEmptySegSequence();
+        for (int i = 0; i < count; ++i) {
+            result->adoptSegment(mapped[i]);
+        }
+        return result;
+    }
+
+    template <typename Predicate>
+    SegmentedSequence<T, SegmentSequence, ContainerSequence>* ParallelWhere(Predicate wherer,
+        ThreadPool& pool = ThreadPool::Shared()) const {
+        DynamicArray<SegmentSequence<T>*> table = segmentTable();
+        int count = table.GetSize();
+        DynamicArray<SegmentSequence<T>*> kept(count);
+
+        try {
+            pool.ParallelForRange(count, segmentGrain(), [&](int begin, int end) {
+                for (int i = begin; i < end; ++i) {
+                    kept[i] = createSegment();
+                    table[i]->ForEach([&](const T& item) {
+                        if (wherer(item)) {
+                            kept[i]->Append(item);
+                        }
+                    });
+                }
+            });
+        } catch (...) {
+            deleteSegments(kept);
+            throw;
+        }
+
+        auto* result = this->CreateEmptySegSequence();
+        for (int i = 0; i < count; ++i) {
+            result->adoptSegment(kept[i]);
+        }
+        return result;
+    }
+
+    // reducer must be associative: runs of segments are reduced independently and the
+    // partial results are then combined pairwise.
+    template <typename Reducer>
+    T ParallelReduce(Reducer reducer, const T& startVal, ThreadPool& pool = ThreadPool::Shared()) const {
+        DynamicArray<SegmentSequence<T>*> table = segmentTable();
+        int count = table.GetSize();
+        int chunks = pool.ChunkCount(count, segmentGrain());
+        DynamicArray<T> partials(chunks);
+        DynamicArray<bool> present(chunks);
+
+        pool.ParallelFor(chunks, [&](int chunk) {
+            int end = ThreadPool::ChunkBegin(count, chunks, chunk + 1);
+            for (int i = ThreadPool::ChunkBegin(count, chunks, chunk); i < end; ++i) {
+                table[i]->ForEach([&](const T& item) {
+                    partials[chunk] = present[chunk] ? reducer(partials[chunk], item) : item;
+                    present[chunk] = true;
+                });
+            }
+        });
+
+        for (int step = 1; step < chunks; step *= 2) {
+            for (int i = 0; i + step < chunks; i += 2 * step) {
+                if (!present[i + step]) continue;
+
+                partials[i] = present[i] ? reducer(partials[i], partials[i + step]) : partials[i + step];
+                present[i] = true;
+            }
+        }
+        return chunks > 0 && present[0] ? reducer(startVal, partials[0]) : startVal;
+    }
+
     virtual Sequence<T>* Append(const T& item) override {
         return this->Instance()->AppendInternal(item);
     }
@@ -327,6 +807,25 @@ public:
         return this->Instance()->ConcatInternal(other);
     }
 
+    virtual Sequence<T>* RemoveAt(int index) override {
+        if (index < 0 || index >= totalSize) {
+            throw std::out_of_range("Index out of range");
+        }
+        return this->Instance()->RemoveAtInternal(index);
+    }
+
+    Sequence<T>* RemoveRange(int startIndex, int endIndex) {
+        if (std::min(startIndex, endIndex) < 0 || std::max(startIndex, endIndex) >= totalSize) {
+            throw std::out_of_range("Invalid range");
+        }
+        return this->Instance()->RemoveRangeInternal(std::min(startIndex, endIndex), std::max(startIndex, endIndex));
+    }
+
+    // Repacks the elements into full segments; an immutable sequence returns a packed copy.
+    Sequence<T>* Compact() {
+        return this->Instance()->CompactInternal();
+    }
+
     Sequence<T>* GetSegment(int idx) {
         return this->segments->Get(idx);
     }
@@ -420,4 +919,89 @@ public:
     virtual SegmentedSequence<T, SegmentSequence, ContainerSequence>* CreateEmptySegSequence() const override {
         return new ImmutableSegmentedSequence<T, SegmentSequence, ContainerSequence>(this->GetSegmentSize());
     }
-};
\ No newline at end of file
+};
+
+
+// Positional reads over a SegmentedSequence that never touch its shared lookup cursor,
+// so several threads can read disjoint ranges at once. Segment starts are captured on
+// construction; the sequence must not change while the reader is in use.
+template <typename Segmented>
+class SegmentRangeReader {
+private:
+    using Segment = typename Segmented::SegmentType;
+
+    DynamicArray<const Segment*> table;
+    DynamicArray<int> starts;
+
+public:
+    explicit SegmentRangeReader(const Segmented& sequence) : starts(1) {
+        table.Reserve(sequence.GetSegmentsLength());
+        starts.Reserve(sequence.GetSegmentsLength() + 1);
+        sequence.GetSegments().ForEach([this](const Segment* segment) {
+            table.EmplaceBack(segment);
+            starts.EmplaceBack(starts[starts.GetSize() - 1] + segment->GetLength());
+        });
+    }
+
+    // Each segment is walked through its own ForEachWhile, not element by element.
+    template <typename Visitor>
+    void ForEach(int startIndex, int endIndex, Visitor visit) const {
+        const int* first = starts.GetData();
+        int segment = static_cast<int>(std::upper_bound(first, first + starts.GetSize(), startIndex) - first) - 1;
+
+        for (int i = startIndex; i < endIndex; ++segment) {
+            int position = first[segment];
+            table.Get(segment)->ForEachWhile([&](const auto& item) {
+                if (position++ >= i) {
+                    visit(item);
+                    ++i;
+                }
+                return i < endIndex;
+            });
+        }
+    }
+};
+
+
+template <typename T1, typename T2,
+    template<typename> class SegmentSequence1, template<typename> class ContainerSequence1,
+    template<typename> class SegmentSequence2, template<typename> class ContainerSequence2>
+Sequence<std::pair<T1, T2>>* parallelZip(const SegmentedSequence<T1, SegmentSequence1, ContainerSequence1>* seq1,
+    const SegmentedSequence<T2, SegmentSequence2, ContainerSequence2>* seq2,
+    ThreadPool& pool = ThreadPool::Shared()) {
+    int min_length = std::min(seq1->GetLength(), seq2->GetLength());
+    auto result = std::make_unique<MutableArraySequence<std::pair<T1, T2>>>(min_length);
+
+    SegmentRangeReader<SegmentedSequence<T1, SegmentSequence1, ContainerSequence1>> reader1(*seq1);
+    SegmentRangeReader<SegmentedSequence<T2, SegmentSequence2, ContainerSequence2>> reader2(*seq2);
+
+    pool.ParallelForRange(min_length, ThreadPool::DefaultGrain, [&](int begin, int end) {
+        int i = begin;
+        reader1.ForEach(begin, end, [&](const T1& item) { result->Get(i++).first = item; });
+        i = begin;
+        reader2.ForEach(begin, end, [&](const T2& item) { result->Get(i++).second = item; });
+    });
+
+    return result.release();
+}
+
+template <typename T1, typename T2,
+    template<typename> class SegmentSequence, template<typename> class ContainerSequence>
+std::pair<Sequence<T1>*, Sequence<T2>*> parallelUnzip(
+    const SegmentedSequence<std::pair<T1, T2>, SegmentSequence, ContainerSequence>* zipped,
+    ThreadPool& pool = ThreadPool::Shared()) {
+    auto seq1 = std::make_unique<MutableArraySequence<T1>>(zipped->GetLength());
+    auto seq2 = std::make_unique<MutableArraySequence<T2>>(zipped->GetLength());
+
+    SegmentRangeReader<SegmentedSequence<std::pair<T1, T2>, SegmentSequence, ContainerSequence>> reader(*zipped);
+
+    pool.ParallelForRange(zipped->GetLength(), ThreadPool::DefaultGrain, [&](int begin, int end) {
+        int i = begin;
+        reader.ForEach(begin, end, [&](const std::pair<T1, T2>& item) {
+            seq1->Get(i) = item.first;
+            seq2->Get(i++) = item.second;
+        });
+    });
+
+    return std::make_pair<Sequence<T1>*, Sequence<T2>*>(seq1.release(), seq2.release());
+}
@@ -2,18 +2,44 @@
 #include <stdexcept>
 #include <memory>
 #include <functional>
+#include <type_traits>
 #include "DynamicArray.hpp"
 #include "LinkedList.hpp"
+#include "PersistentArray.hpp"
+#include "VectorKernels.hpp"
+#include "ThreadPool.hpp"
 
 
 template <typename T>
 class Sequence {
+protected:
+    // Visits the elements in order until visit returns false, and reports whether the walk
+    // reached the end. Containers override it with a walk over their own storage so the
+    // generic algorithms below stay O(n) behind a Sequence<T>*.
+    virtual bool ForEachInternal(const std::function<bool(const T&)>& visit) const {
+        for (int i = 0; i < this->GetLength(); ++i) {
+            if (!visit(this->Get(i))) return false;
+        }
+        return true;
+    }
+
+    // Mappers may take the element alone or the element and its index.
+    template <typename Mapper>
+    static T ApplyMapper(Mapper& mapper, const T& item, int index) {
+        if constexpr (std::is_invocable_v<Mapper&, const T&, int>) {
+            return mapper(item, index);
+        } else {
+            return mapper(item);
+        }
+    }
+
 public:
     virtual Sequence<T>* CreateEmptySequence() const = 0;
     virtual Sequence<T>* AppendInternal(const T& item) = 0;
     virtual Sequence<T>* PrependInternal(const T& item) = 0;
     virtual Sequence<T>* InsertAtInternal(const T& item, int index) = 0;
     virtual Sequence<T>* ConcatInternal(const Sequence<T>* other) = 0;
+    virtual Sequence<T>* RemoveAtInternal(int index) = 0;
 
     virtual ~Sequence() = default;
 
@@ -27,46 +53,66 @@ public:
 
     virtual int GetLength() const = 0;
 
+    // Bytes held by the sequence, including its elements' own heap memory.
+    virtual MemoryUsage GetMemoryUsage() const = 0;
+
     virtual Sequence<T>* Append(const T& item) = 0;
     virtual Sequence<T>* Prepend(const T& item) = 0;
     virtual Sequence<T>* InsertAt(const T& item, int index) = 0;
     virtual Sequence<T>* Concat(const Sequence<T>* other) = 0;
+    virtual Sequence<T>* RemoveAt(int index) = 0;
 
     virtual T& operator[] (int index) = 0;
 
     virtual Sequence<T>* GetSubsequence(int startIndex, int endIndex) const = 0;
 
-    Sequence<T>* Map(std::function<T(T)> mapper) const {
-        Sequence<T>* result = this->CreateEmptySequence();
-        for (int i = 0; i < this->GetLength(); ++i) {
-            result = result->Append(mapper(this->Get(i)));
-        }
-        return result;
+    virtual void Reserve(int) {}
+
+    template <typename Visitor>
+    void ForEach(Visitor visit) const {
+        this->ForEachInternal([&](const T& item) {
+            visit(item);
+            return true;
+        });
     }
 
-    Sequence<T>* Map(std::function<T(T, int)> mapper) const {
+    template <typename Visitor>
+    bool ForEachWhile(Visitor visit) const {
+        return this->ForEachInternal(visit);
+    }
+
+    template <typename Mapper>
+    Sequence<T>* Map(Mapper mapper) const {
         Sequence<T>* result = this->CreateEmptySequence();
-        for (int i = 0; i < this->GetLength(); ++i) {
-            result->Append(mapper(this->Get(i), i));
-        }
+        result->Reserve(this->GetLength());
+
+        int index = 0;
+        this->ForEachInternal([&](const T& item) {
+            result->AppendInternal(ApplyMapper(mapper, item, index++));
+            return true;
+        });
         return result;
     }
 
-    Sequence<T>* Where(std::function<bool(T)> wherer) const {
+    template <typename Predicate>
+    Sequence<T>* Where(Predicate wherer) const {
         Sequence<T>* result = this->CreateEmptySequence();
-        for (int i = 0; i < this->GetLength(); ++i) {
-            if (wherer(this->Get(i))) {
-                result = result->Append(this->Get(i));
+        this->ForEachInternal([&](const T& item) {
+            if (wherer(item)) {
+                result->AppendInternal(item);
             }
-        }
+            return true;
+        });
         return result;
     }
 
-    T& Reduce(std::function<T(T, T)> reducer, const T& startVal) const {
+    template <typename Reducer>
+    T Reduce(Reducer reducer, const T& startVal) const {
         T accumulator = startVal;
-        for (int i = 0; i < this->GetLength(); ++i) {
-            accumulator = reducer(accumulator, this->Get(i));
-        }
+        this->ForEachInternal([&](const T& item) {
+            accumulator = reducer(accumulator, item);
+            return true;
+        });
         return accumulator;
     }
 
@@ -111,53 +157,60 @@ private:
     DynamicArray<T>* data;
 
     virtual Sequence<T>* AppendInternal(const T& item) override {
-        this->data->Resize(data->GetSize() + 1);
-        this->data->Set(item, this->data->GetSize() - 1);
+        this->data->EmplaceBack(item);
         return this;
     }
 
     virtual Sequence<T>* PrependInternal(const T& item) override {
-        this->data->Resize(data->GetSize() + 1);
-
-        for (int i = this->data->GetSize() - 1; i > 0; --i) {
-            this->data->Set(this->data->Get(i - 1), i);
-        }
-
-        this->data->Set(item, 0);
+        this->data->EmplaceFront(item);
         return this;
     }
 
     virtual Sequence<T>* InsertAtInternal(const T& item, int index) override {
-        this->data->Resize(data->GetSize() + 1);
-        if (index == 0)
-            return AppendInternal(item);
+        this->data->InsertAt(item, index);
+        return this;
+    }
 
-        for (int i = this->data->GetSize() - 1; i >= index; --i) {
-            this->data->Set(this->data->Get(i - 1), i);
+    virtual Sequence<T>* ConcatInternal(const Sequence<T>* other) override {
+        return InsertRangeInternal(other, this->data->GetSize());
+    }
+
+    Sequence<T>* InsertRangeInternal(const Sequence<T>* items, int index) {
+        if (items == this) {
+            ArraySequence<T>* copy = this->CreateEmptyArraySequence();
+            *copy = *this;
+            InsertRangeInternal(copy, index);
+            delete copy;
+            return this;
         }
 
-        this->data->Set(item, index);
+        this->data->InsertRange(index, items->GetLength(), [items](int i) -> const T& {
+            return items->Get(i);
+        });
         return this;
     }
 
-    virtual Sequence<T>* ConcatInternal(const Sequence<T>* other) override {
-        for (int i = 0; i < other->GetLength(); ++i) {
-            this->Append(other->Get(i));
-        }
+    virtual Sequence<T>* RemoveAtInternal(int index) override {
+        this->data->RemoveAt(index);
         return this;
     }
 
 protected:
-    virtual Sequence<T>* Instance() = 0;
+    virtual ArraySequence<T>* Instance() = 0;
     virtual ArraySequence<T>* CreateEmptyArraySequence() const = 0;
 
+    virtual bool ForEachInternal(const std::function<bool(const T&)>& visit) const override {
+        return ForEachWhile(visit);
+    }
+
 public:
     ArraySequence() : data(new DynamicArray<T>()) {}
     ArraySequence(int sz) : data(new DynamicArray<T>(sz)) {}
     ArraySequence(const T* items, int count) : data(new DynamicArray<T>(items, count)) {}
-    ArraySequence(const Sequence<T>& other) : data(new DynamicArray<T>(other.GetSize())) {
-        for (int i = 0; i < other.GetSize(); ++i) {
-            data->Append(other.Get(i));
+    ArraySequence(const Sequence<T>& other) : data(new DynamicArray<T>()) {
+        data->Reserve(other.GetLength());
+        for (int i = 0; i < other.GetLength(); ++i) {
+            data->EmplaceBack(other.Get(i));
         }
     }
     ArraySequence(ArraySequence<T>&& other) noexcept : data(other.data) {
@@ -177,10 +230,24 @@ public:
         return this->data->GetCapacity();
     }
 
+    virtual MemoryUsage GetMemoryUsage() const override {
+        MemoryUsage usage = this->data->GetMemoryUsage();
+        usage.overhead += sizeof(*this);
+        return usage;
+    }
+
     void Resize(int newSize) {
         this->data->Resize(newSize);
     }
 
+    void Reserve(int newCapacity) override {
+        this->data->Reserve(newCapacity);
+    }
+
+    void ShrinkToFit() {
+        this->data->ShrinkToFit();
+    }
+
     const T& GetFirst() const override {
         if (this->GetLength() == 0) {
             throw std::out_of_range("Sequence is empty - cannot get first element");
@@ -273,6 +340,183 @@ public:
         return ret;
     }
 
+    template <typename Visitor>
+    void ForEach(Visitor visit) const {
+        const T* items = data->GetData();
+        for (int i = 0; i < data->GetSize(); ++i) {
+            visit(items[i]);
+        }
+    }
+
+    template <typename Visitor>
+    bool ForEachWhile(Visitor visit) const {
+        const T* items = data->GetData();
+        for (int i = 0; i < data->GetSize(); ++i) {
+            if (!visit(items[i])) return false;
+        }
+        return true;
+    }
+
+    template <typename Mapper>
+    ArraySequence<T>* Map(Mapper mapper) const {
+        ArraySequence<T>* result = this->CreateEmptyArraySequence();
+        const T* items = data->GetData();
+        int length = data->GetSize();
+
+        result->data->Reserve(length);
+        for (int i = 0; i < length; ++i) {
+            result->data->EmplaceBack(Sequence<T>::ApplyMapper(mapper, items[i], i));
+        }
+        return result;
+    }
+
+    template <typename Predicate>
+    ArraySequence<T>* Where(Predicate wherer) const {
+        ArraySequence<T>* result = this->CreateEmptyArraySequence();
+        const T* items = data->GetData();
+
+        for (int i = 0; i < data->GetSize(); ++i) {
+            if (wherer(items[i])) {
+                result->data->EmplaceBack(items[i]);
+            }
+        }
+        return result;
+    }
+
+    template <typename Reducer>
+    T Reduce(Reducer reducer, const T& startVal) const {
+        T accumulator = startVal;
+        ForEach([&](const T& item) {
+            accumulator = reducer(accumulator, item);
+        });
+        return accumulator;
+    }
+
+    // Parallel algorithms split the array into contiguous chunks run on pool. The callables
+    // are invoked concurrently and must be safe to call from several threads.
+    template <typename Mapper>
+    ArraySequence<T>* ParallelMap(Mapper mapper, ThreadPool& pool = ThreadPool::Shared()) const {
+        std::unique_ptr<ArraySequence<T>> result(this->CreateEmptyArraySequence());
+        const T* items = data->GetData();
+        result->data->ResizeForOverwrite(data->GetSize());
+        T* out = result->data->GetData();
+
+        pool.ParallelForRange(data->GetSize(), ThreadPool::DefaultGrain, [&](int begin, int end) {
+            for (int i = begin; i < end; ++i) {
+                out[i] = Sequence<T>::ApplyMapper(mapper, items[i], i);
+            }
+        });
+        return result.release();
+    }
+
+    // Marks the kept items per chunk, prefix-sums the chunk counts and then copies every
+    // chunk to its own offset in the result.
+    template <typename Predicate>
+    ArraySequence<T>* ParallelWhere(Predicate wherer, ThreadPool& pool = ThreadPool::Shared()) const {
+        const T* items = data->GetData();
+        int length = data->GetSize();
+        int chunks = pool.ChunkCount(length, ThreadPool::DefaultGrain);
+
+        DynamicArray<bool> keep(length);
+        DynamicArray<int> offsets(chunks + 1);
+        bool* flags = keep.GetData();
+        int* offset = offsets.GetData();
+
+        pool.ParallelFor(chunks, [&](int chunk) {
+            int end = ThreadPool::ChunkBegin(length, chunks, chunk + 1);
+            int kept = 0;
+            for (int i = ThreadPool::ChunkBegin(length, chunks, chunk); i < end; ++i) {
+                flags[i] = wherer(items[i]);
+                kept += flags[i];
+            }
+            offset[chunk + 1] = kept;
+        });
+        for (int chunk = 0; chunk < chunks; ++chunk) {
+            offset[chunk + 1] += offset[chunk];
+        }
+
+        // Owned until returned, so a throwing copy or resize does not leak it.
+        std::unique_ptr<ArraySequence<T>> result(this->CreateEmptyArraySequence());
+        result->data->ResizeForOverwrite(offset[chunks]);
+        T* out = result->data->GetData();
+
+        pool.ParallelFor(chunks, [&](int chunk) {
+            int end = ThreadPool::ChunkBegin(length, chunks, chunk + 1);
+            int position = offset[chunk];
+            for (int i = ThreadPool::ChunkBegin(length, chunks, chunk); i < end; ++i) {
+                if (flags[i]) out[position++] = items[i];
+            }
+        });
+        return result.release();
+    }
+
+    // reducer must be associative: chunks are reduced independently and the partial
+    // results are then combined pairwise.
+    template <typename Reducer>
+    T ParallelReduce(Reducer reducer, const T& startVal, ThreadPool& pool = ThreadPool::Shared()) const {
+        const T* items = data->GetData();
+        int length = data->GetSize();
+        int chunks = pool.ChunkCount(length, ThreadPool::DefaultGrain);
+        if (chunks == 0) return startVal;
+
+        DynamicArray<T> partials(chunks);
+        pool.ParallelFor(chunks, [&](int chunk) {
+            int begin = ThreadPool::ChunkBegin(length, chunks, chunk);
+            int end = ThreadPool::ChunkBegin(length, chunks, chunk + 1);
+
+            T accumulator = items[begin];
+            for (int i = begin + 1; i < end; ++i) {
+                accumulator = reducer(accumulator, items[i]);
+            }
+            partials[chunk] = accumulator;
+        });
+
+        for (int step = 1; step < chunks; step *= 2) {
+            for (int i = 0; i + step < chunks; i += 2 * step) {
+                partials[i] = reducer(partials[i], partials[i + step]);
+            }
+        }
+        return reducer(startVal, partials[0]);
+    }
+
+    // Vectorised algorithms for arithmetic element types, see VectorKernels.
+    T Sum() const {
+        return VectorKernels<T>::Sum(data->GetData(), data->GetSize());
+    }
+
+    T Min() const {
+        if (this->GetLength() == 0) {
+            throw std::out_of_range("Sequence is empty - cannot get minimum");
+        }
+
+        return VectorKernels<T>::Min(data->GetData(), data->GetSize());
+    }
+
+    T Max() const {
+        if (this->GetLength() == 0) {
+            throw std::out_of_range("Sequence is empty - cannot get maximum");
+        }
+
+        return VectorKernels<T>::Max(data->GetData(), data->GetSize());
+    }
+
+    ArraySequence<T>* MapAffine(const T& scale, const T& shift) const {
+        ArraySequence<T>* result = this->CreateEmptyArraySequence();
+        result->data->ResizeForOverwrite(data->GetSize());
+
+        VectorKernels<T>::Affine(data->GetData(), data->GetSize(), scale, shift, result->data->GetData());
+        return result;
+    }
+
+    ArraySequence<T>* WhereCompare(CompareOp op, const T& value) const {
+        ArraySequence<T>* result = this->CreateEmptyArraySequence();
+        result->data->ResizeForOverwrite(data->GetSize());
+
+        int kept = VectorKernels<T>::Compress(data->GetData(), data->GetSize(), op, value, result->data->GetData());
+        result->data->Resize(kept);
+        return result;
+    }
+
     virtual Sequence<T>* Append(const T& item) override {
         return Instance()->AppendInternal(item);
     }
@@ -292,6 +536,22 @@ public:
     virtual Sequence<T>* Concat(const Sequence<T>* other) override {
         return this->Instance()->ConcatInternal(other);
     }
+
+    Sequence<T>* InsertRange(const Sequence<T>* items, int index) {
+        if (index < 0 || index > data->GetSize()) {
+            throw std::out_of_range("ArraySequence index out of range");
+        }
+
+        return Instance()->InsertRangeInternal(items, index);
+    }
+
+    virtual Sequence<T>* RemoveAt(int index) override {
+        if (index < 0 || index >= data->GetSize()) {
+            throw std::out_of_range("ArraySequence index out of range");
+        }
+
+        return Instance()->RemoveAtInternal(index);
+    }
 };
 
 template <typename T> class MutableListSequence;
@@ -318,9 +578,20 @@ private:
     }
 
     virtual Sequence<T>* ConcatInternal(const Sequence<T>* other) override {
-        for (int i = 0; i < other->GetLength(); ++i) {
-            this->Append(other->Get(i));
+        if (other == this) {
+            LinkedList<T> copy(*this->data);
+            this->data->MoveConcat(copy);
+            return this;
         }
+
+        other->ForEach([this](const T& item) {
+            this->data->Append(item);
+        });
+        return this;
+    }
+
+    virtual Sequence<T>* RemoveAtInternal(int index) override {
+        this->data->RemoveAt(index);
         return this;
     }
 
@@ -328,13 +599,17 @@ protected:
     virtual Sequence<T>* Instance() = 0;
     virtual ListSequence<T>* CreateEmptyListSequence() const = 0;
 
+    virtual bool ForEachInternal(const std::function<bool(const T&)>& visit) const override {
+        return this->data->ForEachWhile(visit);
+    }
+
 public:
     ListSequence() : data(new LinkedList<T>()) {}
     ListSequence(const T* items, int count) : data(new LinkedList<T>(items, count)) {}
     ListSequence(const Sequence<T>& other) : data(new LinkedList<T>()) {
-        for (int i = 0; i < other.GetSize(); ++i) {
-            data->Set(i, other.Get(i));
-        }
+        other.ForEach([this](const T& item) {
+            data->Append(item);
+        });
     }
     ListSequence(ListSequence<T>&& other) noexcept : data(other.data) {
         other.data = nullptr;
@@ -349,6 +624,12 @@ public:
         return this->data->GetSize();
     }
 
+    virtual MemoryUsage GetMemoryUsage() const override {
+        MemoryUsage usage = this->data->GetMemoryUsage();
+        usage.overhead += sizeof(*this);
+        return usage;
+    }
+
     const T& GetFirst() const override {
         if (this->GetLength() == 0) {
             throw std::out_of_range("Sequence is empty - cannot get first element");
@@ -424,11 +705,146 @@ public:
         }
 
         ListSequence<T>* ret = this->CreateEmptyListSequence();
+        delete ret->data;
         ret->data = this->data->GetSubList(startIndex, endIndex);
 
         return ret;
     }
 
+    // Node cursors: stepping is O(1), unlike Sequence::Iterator, which calls Get(index).
+    using Iterator = typename LinkedList<T>::Iterator;
+    using ConstIterator = typename LinkedList<T>::ConstIterator;
+    using ReverseIterator = typename LinkedList<T>::ReverseIterator;
+    using ConstReverseIterator = typename LinkedList<T>::ConstReverseIterator;
+
+    Iterator begin() {
+        return this->data->begin();
+    }
+
+    Iterator end() {
+        return this->data->end();
+    }
+
+    ConstIterator begin() const {
+        return this->data->cbegin();
+    }
+
+    ConstIterator end() const {
+        return this->data->cend();
+    }
+
+    ConstIterator cbegin() const {
+        return this->data->cbegin();
+    }
+
+    ConstIterator cend() const {
+        return this->data->cend();
+    }
+
+    ReverseIterator rbegin() {
+        return this->data->rbegin();
+    }
+
+    ReverseIterator rend() {
+        return this->data->rend();
+    }
+
+    ConstReverseIterator rbegin() const {
+        return static_cast<const LinkedList<T>*>(this->data)->rbegin();
+    }
+
+    ConstReverseIterator rend() const {
+        return static_cast<const LinkedList<T>*>(this->data)->rend();
+    }
+
+    Iterator At(int index) {
+        if (index < 0 || index >= data->GetSize()) {
+            throw std::out_of_range("Sequence index out of range");
+        }
+        return this->data->At(index);
+    }
+
+    Iterator InsertAfter(Iterator position, const T& item) {
+        return this->data->InsertAfter(position, item);
+    }
+
+    Iterator InsertBefore(Iterator position, const T& item) {
+        return this->data->InsertBefore(position, item);
+    }
+
+    Iterator Erase(Iterator position) {
+        return this->data->Erase(position);
+    }
+
+    // Moves every element of other to the end of this sequence in O(1), leaving other
+    // empty.
+    ListSequence<T>* MoveConcat(ListSequence<T>& other) {
+        this->data->MoveConcat(*other.data);
+        return this;
+    }
+
+    // Moves every element of other in front of index, leaving other empty.
+    ListSequence<T>* Splice(int index, ListSequence<T>& other) {
+        this->data->Splice(index, *other.data);
+        return this;
+    }
+
+    // Removes the elements startIndex..endIndex from this sequence and returns them
+    // as a new sequence; the nodes are relinked rather than copied.
+    ListSequence<T>* ExtractSubsequence(int startIndex, int endIndex) {
+        ListSequence<T>* ret = this->CreateEmptyListSequence();
+        try {
+            LinkedList<T>* extracted = this->data->ExtractSubList(startIndex, endIndex);
+            delete ret->data;
+            ret->data = extracted;
+        } catch (...) {
+            delete ret;
+            throw;
+        }
+
+        return ret;
+    }
+
+    template <typename Visitor>
+    void ForEach(Visitor visit) const {
+        this->data->ForEach(visit);
+    }
+
+    template <typename Visitor>
+    bool ForEachWhile(Visitor visit) const {
+        return this->data->ForEachWhile(visit);
+    }
+
+    template <typename Mapper>
+    ListSequence<T>* Map(Mapper mapper) const {
+        ListSequence<T>* result = this->CreateEmptyListSequence();
+        int index = 0;
+        this->data->ForEach([&](const T& item) {
+            result->data->Append(Sequence<T>::ApplyMapper(mapper, item, index++));
+        });
+        return result;
+    }
+
+    template <typename Predicate>
+    ListSequence<T>* Where(Predicate wherer) const {
+        ListSequence<T>* result = this->CreateEmptyListSequence();
+        this->data->ForEach([&](const T& item) {
+            if (wherer(item)) {
+                result->data->Append(item);
+            }
+        });
+        return result;
+    }
+
+    template <typename Reducer>
+    T Reduce(Reducer reducer, const T& startVal) const {
+        T accumulator = startVal;
+        this->data->ForEach([&](const T& item) {
+            accumulator = reducer(accumulator, item);
+        });
+        return accumulator;
+    }
+
     virtual Sequence<T>* Append(const T& item) override {
         return this->Instance()->AppendInternal(item);
     }
@@ -447,10 +863,194 @@ public:
     virtual Sequence<T>* Concat(const Sequence<T>* other) override {
         return this->Instance()->ConcatInternal(other);
     }
+
+    virtual Sequence<T>* RemoveAt(int index) override {
+        if (index < 0 || index >= this->data->GetSize()) {
+            throw std::out_of_range("Sequence index out of range");
+        }
+        return this->Instance()->RemoveAtInternal(index);
+    }
 };
 
 
 
+// Base of the immutable sequences. Versions share structure through PersistentArray,
+// so Instance() is an O(1) copy and each update costs O(log n) instead of a full clone.
+template <typename T>
+class PersistentSequence : public Sequence<T> {
+private:
+    PersistentArray<T> data;
+
+    virtual Sequence<T>* AppendInternal(const T& item) override {
+        this->data = this->data.Append(item);
+        return this;
+    }
+
+    virtual Sequence<T>* PrependInternal(const T& item) override {
+        this->data = this->data.Prepend(item);
+        return this;
+    }
+
+    virtual Sequence<T>* InsertAtInternal(const T& item, int index) override {
+        this->data = this->data.InsertAt(item, index);
+        return this;
+    }
+
+    virtual Sequence<T>* ConcatInternal(const Sequence<T>* other) override {
+        const PersistentSequence<T>* persistent = dynamic_cast<const PersistentSequence<T>*>(other);
+        if (persistent) {
+            this->data = this->data.Concat(persistent->data);
+            return this;
+        }
+
+        other->ForEach([this](const T& item) {
+            this->data = this->data.Append(item);
+        });
+        return this;
+    }
+
+    virtual Sequence<T>* RemoveAtInternal(int index) override {
+        this->data = this->data.RemoveAt(index);
+        return this;
+    }
+
+    static PersistentArray<T> collect(const Sequence<T>& other) {
+        DynamicArray<T> items;
+        items.Reserve(other.GetLength());
+        other.ForEach([&items](const T& item) {
+            items.EmplaceBack(item);
+        });
+        return PersistentArray<T>(items.GetData(), items.GetSize());
+    }
+
+protected:
+    virtual PersistentSequence<T>* Instance() = 0;
+    virtual PersistentSequence<T>* CreateEmptyPersistentSequence() const = 0;
+
+    virtual bool ForEachInternal(const std::function<bool(const T&)>& visit) const override {
+        return this->data.ForEachWhile(visit);
+    }
+
+public:
+    PersistentSequence() : data() {}
+    PersistentSequence(const T* items, int count) : data(items, count) {}
+    PersistentSequence(const Sequence<T>& other) : data(collect(other)) {}
+    PersistentSequence(const PersistentSequence<T>& other) : data(other.data) {}
+
+    virtual int GetLength() const override {
+        return this->data.GetSize();
+    }
+
+    // Versions share unchanged chunks, so this counts every chunk reachable from this one.
+    virtual MemoryUsage GetMemoryUsage() const override {
+        MemoryUsage usage = this->data.GetMemoryUsage();
+        usage.overhead += sizeof(*this) - sizeof(this->data);
+        return usage;
+    }
+
+    const T& GetFirst() const override {
+        if (this->GetLength() == 0) {
+            throw std::out_of_range("Sequence is empty - cannot get first element");
+        }
+
+        return this->data.Get(0);
+    }
+
+    const T& GetLast() const override {
+        if (this->GetLength() == 0) {
+            throw std::out_of_range("Sequence is empty - cannot get last element");
+        }
+
+        return this->data.Get(this->data.GetSize() - 1);
+    }
+
+    const T& Get(int index) const override {
+        if (index < 0 || index >= this->data.GetSize()) {
+            throw std::out_of_range("Sequence index out of range");
+        }
+
+        return this->data.Get(index);
+    }
+
+    // Writable accessors copy the shared part of the path first (copy-on-write).
+    T& GetFirst() override {
+        if (this->GetLength() == 0) {
+            throw std::out_of_range("Sequence is empty - cannot get first element");
+        }
+
+        return this->data.GetMutable(0);
+    }
+
+    T& GetLast() override {
+        if (this->GetLength() == 0) {
+            throw std::out_of_range("Sequence is empty - cannot get last element");
+        }
+
+        return this->data.GetMutable(this->data.GetSize() - 1);
+    }
+
+    T& Get(int index) override {
+        if (index < 0 || index >= this->data.GetSize()) {
+            throw std::out_of_range("Sequence index out of range");
+        }
+
+        return this->data.GetMutable(index);
+    }
+
+    T& operator[] (int index) override {
+        return this->Get(index);
+    }
+
+    PersistentSequence<T>& operator=(const PersistentSequence<T>& other) {
+        this->data = other.data;
+        return *this;
+    }
+
+    Sequence<T>* GetSubsequence(int startIndex, int endIndex) const override {
+        if (std::min(startIndex, endIndex) < 0 || std::max(startIndex, endIndex) >= this->data.GetSize()) {
+            throw std::out_of_range("Sequence index out of range");
+        }
+
+        PersistentSequence<T>* ret = this->CreateEmptyPersistentSequence();
+        if (startIndex <= endIndex) {
+            ret->data = this->data.GetSubArray(startIndex, endIndex);
+        } else {
+            for (int i = startIndex; i >= endIndex; --i) {
+                ret->data = ret->data.Append(this->data.Get(i));
+            }
+        }
+
+        return ret;
+    }
+
+    virtual Sequence<T>* Append(const T& item) override {
+        return this->Instance()->AppendInternal(item);
+    }
+
+    virtual Sequence<T>* Prepend(const T& item) override {
+        return this->Instance()->PrependInternal(item);
+    }
+
+    virtual Sequence<T>* InsertAt(const T& item, int index) override {
+        if (index < 0 || index >= this->data.GetSize()) {
+            throw std::out_of_range("Sequence index out of range");
+        }
+        return this->Instance()->InsertAtInternal(item, index);
+    }
+
+    virtual Sequence<T>* Concat(const Sequence<T>* other) override {
+        return this->Instance()->ConcatInternal(other);
+    }
+
+    virtual Sequence<T>* RemoveAt(int index) override {
+        if (index < 0 || index >= this->data.GetSize()) {
+            throw std::out_of_range("Sequence index out of range");
+        }
+        return this->Instance()->RemoveAtInternal(index);
+    }
+};
+
+
 struct MutableSequenceTag {};
 struct ImmutableSequenceTag {};
 
@@ -478,34 +1078,6 @@ public:
 };
 
 
-template <typename T>
-class ImmutableArraySequence : public ArraySequence<T> {
-private:
-    ArraySequence<T>* Clone() const {
-        return new ImmutableArraySequence<T>(*this);
-    }
-
-public:
-    using tag = ImmutableSequenceTag;
-
-    ImmutableArraySequence() : ArraySequence<T>() {}
-    ImmutableArraySequence(int sz) : ArraySequence<T>(sz) {}
-    ImmutableArraySequence(const T* items, int count) : ArraySequence<T>(items, count) {}
-    ImmutableArraySequence(const Sequence<T>& other) : ArraySequence<T>(other) {}
-    ImmutableArraySequence(ArraySequence<T>&& other) : ArraySequence<T>(std::move(other)) {}
-
-    virtual Sequence<T>* CreateEmptySequence() const override { 
-        return new ImmutableArraySequence<T>();
-    }
-    virtual ArraySequence<T>* CreateEmptyArraySequence() const override {
-        return new ImmutableArraySequence<T>();
-    }
-    virtual ArraySequence<T>* Instance() override {
-        return Clone();
-    }
-};
-
-
 template <typename T>
 class MutableListSequence : public ListSequence<T> {
 public:
@@ -529,28 +1101,55 @@ public:
 
 
 template <typename T>
-class ImmutableListSequence : public ListSequence<T> {
+class ImmutableArraySequence : public PersistentSequence<T> {
+private:
+    PersistentSequence<T>* Clone() const {
+        return new ImmutableArraySequence<T>(*this);
+    }
+
+public:
+    using tag = ImmutableSequenceTag;
+
+    ImmutableArraySequence() : PersistentSequence<T>() {}
+    ImmutableArraySequence(int sz) : PersistentSequence<T>(DynamicArray<T>(sz).GetData(), sz) {}
+    ImmutableArraySequence(const T* items, int count) : PersistentSequence<T>(items, count) {}
+    ImmutableArraySequence(const Sequence<T>& other) : PersistentSequence<T>(other) {}
+    ImmutableArraySequence(const ImmutableArraySequence<T>& other) : PersistentSequence<T>(other) {}
+
+    virtual Sequence<T>* CreateEmptySequence() const override { 
+        return new ImmutableArraySequence<T>();
+    }
+    virtual PersistentSequence<T>* CreateEmptyPersistentSequence() const override {
+        return new ImmutableArraySequence<T>();
+    }
+    virtual PersistentSequence<T>* Instance() override {
+        return Clone();
+    }
+};
+
+
+template <typename T>
+class ImmutableListSequence : public PersistentSequence<T> {
 private:
-    ListSequence<T>* Clone() const {
+    PersistentSequence<T>* Clone() const {
         return new ImmutableListSequence<T>(*this);
     }
 
 public:
     using tag = ImmutableSequenceTag;
 
-    ImmutableListSequence() : ListSequence<T>() {}
-    ImmutableListSequence(const T* items, int count) : ListSequence<T>(items, count) {}
-    ImmutableListSequence(const Sequence<T>& other) : ListSequence<T>(other) {}
-    ImmutableListSequence(ListSequence<T>&& other) : ListSequence<T>(std::move(other)) {}
-    ImmutableListSequence(const ImmutableListSequence<T>& other) : ListSequence<T>(other) {}
+    ImmutableListSequence() : PersistentSequence<T>() {}
+    ImmutableListSequence(const T* items, int count) : PersistentSequence<T>(items, count) {}
+    ImmutableListSequence(const Sequence<T>& other) : PersistentSequence<T>(other) {}
+    ImmutableListSequence(const ImmutableListSequence<T>& other) : PersistentSequence<T>(other) {}
 
     virtual Sequence<T>* CreateEmptySequence() const override { 
         return new ImmutableListSequence<T>();
     }
-    virtual ListSequence<T>* CreateEmptyListSequence() const override {
+    virtual PersistentSequence<T>* CreateEmptyPersistentSequence() const override {
         return new ImmutableListSequence<T>();
     }
-    virtual ListSequence<T>* Instance() override {
+    virtual PersistentSequence<T>* Instance() override {
         return Clone();
     }
 };
@@ -573,10 +1172,41 @@ std::pair<Sequence<T1>*, Sequence<T2>*> unzip(const Sequence<std::pair<T1, T2>>*
     auto* seq1 = new MutableArraySequence<T1>();
     auto* seq2 = new MutableArraySequence<T2>();
 
-    for (auto& pair : *zipped) {
+    zipped->ForEach([&](const std::pair<T1, T2>& pair) {
         seq1->Append(pair.first);
         seq2->Append(pair.second);
-    }
+    });
 
     return std::make_pair(seq1, seq2);
-}
\ No newline at end of file
+}
+
+template <typename T1, typename T2>
+Sequence<std::pair<T1, T2>>* parallelZip(const ArraySequence<T1>* seq1, const ArraySequence<T2>* seq2,
+    ThreadPool& pool = ThreadPool::Shared()) {
+    int min_length = std::min(seq1->GetLength(), seq2->GetLength());
+    auto result = std::make_unique<MutableArraySequence<std::pair<T1, T2>>>(min_length);
+
+    pool.ParallelForRange(min_length, ThreadPool::DefaultGrain, [&](int begin, int end) {
+        for (int i = begin; i < end; ++i) {
+            result->Get(i) = std::make_pair(seq1->Get(i), seq2->Get(i));
+        }
+    });
+
+    return result.release();
+}
+
+template <typename T1, typename T2>
+std::pair<Sequence<T1>*, Sequence<T2>*> parallelUnzip(const ArraySequence<std::pair<T1, T2>>* zipped,
+    ThreadPool& pool = ThreadPool::Shared()) {
+    auto seq1 = std::make_unique<MutableArraySequence<T1>>(zipped->GetLength());
+    auto seq2 = std::make_unique<MutableArraySequence<T2>>(zipped->GetLength());
+
+    pool.ParallelForRange(zipped->GetLength(), ThreadPool::DefaultGrain, [&](int begin, int end) {
+        for (int i = begin; i < end; ++i) {
+            seq1->Get(i) = zipped->Get(i).first;
+            seq2->Get(i) = zipped->Get(i).second;
+        }
+    });
+
+    return std::make_pair<Sequence<T1>*, Sequence<T2>*>(seq1.release(), seq2.release());
+}
@@ -0,0 +1,176 @@
+#pragma once
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include "Sequence.hpp"
+
+
+// Lazy pipeline over a sequence. Map, Where, Zip, Take and Skip only compose the
+// stages; nothing is read or allocated until a terminal operation (ForEach, Reduce,
+// Count, Collect, CollectInto, or Set::insertAll) pushes the elements through all
+// stages in one pass.
+//
+// A view keeps references to the sequences it reads from, which must outlive it.
+// Producer is a callable that pushes every element to sink(item) until the sink
+// returns false, and reports whether it reached the end.
+template <typename T, typename Producer>
+class SequenceView {
+private:
+    Producer producer;
+
+public:
+    using value_type = T;
+
+    explicit SequenceView(Producer producer_) : producer(std::move(producer_)) {}
+
+    template <typename Sink>
+    bool Run(Sink&& sink) const {
+        return producer(sink);
+    }
+
+    template <typename Mapper>
+    auto Map(Mapper mapper) const {
+        using U = std::decay_t<std::invoke_result_t<const Mapper&, const T&>>;
+
+        auto next = [source = producer, mapper](auto&& sink) {
+            return source([&](const T& item) {
+                return sink(mapper(item));
+            });
+        };
+        return SequenceView<U, decltype(next)>(std::move(next));
+    }
+
+    template <typename Predicate>
+    auto Where(Predicate wherer) const {
+        auto next = [source = producer, wherer](auto&& sink) {
+            return source([&](const T& item) {
+                return !wherer(item) || sink(item);
+            });
+        };
+        return SequenceView<T, decltype(next)>(std::move(next));
+    }
+
+    // Pairs elements with other.Get(0), other.Get(1), ... and stops at the shorter side.
+    // other should have O(1) Get, e.g. an ArraySequence.
+    template <typename U>
+    auto Zip(const Sequence<U>& other) const {
+        auto next = [source = producer, second = &other](auto&& sink) {
+            int index = 0;
+            bool stopped = false;
+
+            source([&](const T& item) {
+                if (index >= second->GetLength()) return false;
+                if (!sink(std::pair<T, U>(item, second->Get(index++)))) {
+                    stopped = true;
+                    return false;
+                }
+                return true;
+            });
+            return !stopped;
+        };
+        return SequenceView<std::pair<T, U>, decltype(next)>(std::move(next));
+    }
+
+    auto Take(int count) const {
+        if (count < 0) {
+            throw std::invalid_argument("Count must be non-negative");
+        }
+
+        auto next = [source = producer, count](auto&& sink) {
+            int taken = 0;
+            bool stopped = false;
+            if (count == 0) return true;
+
+            source([&](const T& item) {
+                if (!sink(item)) {
+                    stopped = true;
+                    return false;
+                }
+                return ++taken < count;
+            });
+            return !stopped;
+        };
+        return SequenceView<T, decltype(next)>(std::move(next));
+    }
+
+    auto Skip(int count) const {
+        if (count < 0) {
+            throw std::invalid_argument("Count must be non-negative");
+        }
+
+        auto next = [source = producer, count](auto&& sink) {
+            int skipped = 0;
+            return source([&](const T& item) {
+                if (skipped < count) {
+                    ++skipped;
+                    return true;
+                }
+                return sink(item);
+            });
+        };
+        return SequenceView<T, decltype(next)>(std::move(next));
+    }
+
+    template <typename Visitor>
+    void ForEach(Visitor visit) const {
+        Run([&](const T& item) {
+            visit(item);
+            return true;
+        });
+    }
+
+    template <typename Reducer>
+    T Reduce(Reducer reducer, const T& startVal) const {
+        T accumulator = startVal;
+        ForEach([&](const T& item) {
+            accumulator = reducer(accumulator, item);
+        });
+        return accumulator;
+    }
+
+    int Count() const {
+        int count = 0;
+        ForEach([&](const T&) { ++count; });
+        return count;
+    }
+
+    // Builds a new Result (any default-constructible Sequence<T>) from the view.
+    template <typename Result = MutableArraySequence<T>>
+    Result* Collect() const {
+        auto result = std::make_unique<Result>();
+        Sequence<T>* target = result.get();
+
+        ForEach([&](const T& item) {
+            target->AppendInternal(item);
+        });
+        return result.release();
+    }
+
+    // Appends the view to an existing mutable sequence.
+    template <typename Target>
+    Target& CollectInto(Target& target) const {
+        static_assert(std::is_base_of_v<MutableSequenceTag, typename Target::tag>,
+            "CollectInto requires a mutable sequence type");
+
+        ForEach([&](const T& item) {
+            target.Append(item);
+        });
+        return target;
+    }
+};
+
+
+// Starts a pipeline over sequence. With a concrete container type the traversal is
+// resolved statically; through a Sequence<T>& it goes through one virtual walk.
+template <typename SequenceType>
+auto viewOf(const SequenceType& sequence) {
+    using T = std::decay_t<decltype(sequence.Get(0))>;
+
+    auto producer = [source = &sequence](auto&& sink) {
+        return source->ForEachWhile([&](const T& item) {
+            return sink(item);
+        });
+    };
+    return SequenceView<T, decltype(producer)>(std::move(producer));
+}
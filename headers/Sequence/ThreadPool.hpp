@@ -0,0 +1,207 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+// Fixed set of workers, each owning a task deque. A worker pops its own newest task and,
+// when it runs dry, steals the oldest task of another worker. Threads blocked in
+// ParallelFor run queued tasks instead of sleeping, so nested parallel calls cannot
+// deadlock the pool.
+class ThreadPool {
+private:
+    using Task = std::function<void()>;
+
+    struct WorkQueue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    std::vector<std::unique_ptr<WorkQueue>> queues;
+    std::vector<std::thread> workers;
+
+    std::mutex sleepMutex;
+    std::condition_variable wakeUp;
+    std::atomic<int> queued;
+    std::atomic<unsigned> nextQueue;
+    bool stopping;
+
+    struct WorkerIdentity {
+        const ThreadPool* pool = nullptr;
+        int index = -1;
+    };
+
+    static WorkerIdentity& currentWorker() {
+        thread_local WorkerIdentity identity;
+        return identity;
+    }
+
+    int workerIndex() const {
+        const WorkerIdentity& identity = currentWorker();
+        return identity.pool == this ? identity.index : -1;
+    }
+
+    bool popTask(int queueIndex, bool newest, Task& task) {
+        WorkQueue& queue = *queues[queueIndex];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.tasks.empty()) return false;
+
+        if (newest) {
+            task = std::move(queue.tasks.back());
+            queue.tasks.pop_back();
+        } else {
+            task = std::move(queue.tasks.front());
+            queue.tasks.pop_front();
+        }
+        --queued;
+        return true;
+    }
+
+    bool runPendingTask(int self) {
+        int count = static_cast<int>(queues.size());
+        Task task;
+
+        bool found = self >= 0 && popTask(self, true, task);
+        int start = self >= 0 ? self + 1 : static_cast<int>(nextQueue.load() % count);
+        for (int i = 0; !found && i < count; ++i) {
+            found = popTask((start + i) % count, false, task);
+        }
+
+        if (found) task();
+        return found;
+    }
+
+    void workerLoop(int index) {
+        currentWorker() = WorkerIdentity{this, index};
+
+        while (true) {
+            if (runPendingTask(index)) continue;
+
+            std::unique_lock<std::mutex> lock(sleepMutex);
+            wakeUp.wait(lock, [this] { return stopping || queued.load() > 0; });
+            if (stopping && queued.load() == 0) return;
+        }
+    }
+
+public:
+    // Default minimum number of elements per task for the parallel sequence algorithms.
+    static constexpr int DefaultGrain = 4096;
+
+    // threadCount workers are started; the thread calling ParallelFor takes part as well.
+    explicit ThreadPool(int threadCount = static_cast<int>(std::thread::hardware_concurrency()) - 1) :
+        queued(0), nextQueue(0), stopping(false) {
+        threadCount = std::max(threadCount, 0);
+
+        for (int i = 0; i < std::max(threadCount, 1); ++i) {
+            queues.push_back(std::make_unique<WorkQueue>());
+        }
+        for (int i = 0; i < threadCount; ++i) {
+            workers.emplace_back([this, i] { workerLoop(i); });
+        }
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(sleepMutex);
+            stopping = true;
+        }
+        wakeUp.notify_all();
+
+        for (std::thread& worker : workers) {
+            worker.join();
+        }
+    }
+
+    static ThreadPool& Shared() {
+        static ThreadPool pool;
+        return pool;
+    }
+
+    int GetThreadCount() const {
+        return static_cast<int>(workers.size());
+    }
+
+    void Submit(Task task) {
+        int self = workerIndex();
+        int target = self >= 0 ? self : static_cast<int>(nextQueue++ % queues.size());
+        {
+            std::lock_guard<std::mutex> lock(queues[target]->mutex);
+            queues[target]->tasks.push_back(std::move(task));
+            ++queued;
+        }
+        {
+            std::lock_guard<std::mutex> lock(sleepMutex);
+        }
+        wakeUp.notify_one();
+    }
+
+    // Number of chunks to cut count items into so that no chunk is smaller than grain
+    // and every thread gets a few chunks to balance uneven work.
+    int ChunkCount(int count, int grain) const {
+        if (count <= 0) return 0;
+
+        int byGrain = (count + std::max(grain, 1) - 1) / std::max(grain, 1);
+        return std::max(1, std::min(byGrain, 4 * (GetThreadCount() + 1)));
+    }
+
+    // Runs body(task) for every task in [0, taskCount) and returns when all have finished.
+    // The first exception thrown by a task is rethrown here.
+    template <typename Body>
+    void ParallelFor(int taskCount, Body body) {
+        if (taskCount <= 0) return;
+        if (taskCount == 1 || workers.empty()) {
+            for (int task = 0; task < taskCount; ++task) body(task);
+            return;
+        }
+
+        std::atomic<int> remaining(taskCount);
+        std::exception_ptr error;
+        std::mutex errorMutex;
+
+        auto run = [&](int task) {
+            try {
+                body(task);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(errorMutex);
+                if (!error) error = std::current_exception();
+            }
+            --remaining;
+        };
+
+        for (int task = 1; task < taskCount; ++task) {
+            Submit([&run, task] { run(task); });
+        }
+        run(0);
+
+        int self = workerIndex();
+        while (remaining.load() > 0) {
+            if (!runPendingTask(self)) std::this_thread::yield();
+        }
+
+        if (error) std::rethrow_exception(error);
+    }
+
+    // Splits [0, count) into ChunkCount(count, grain) contiguous ranges and runs
+    // body(begin, end) on each of them in parallel.
+    template <typename Body>
+    void ParallelForRange(int count, int grain, Body body) {
+        int chunks = ChunkCount(count, grain);
+        ParallelFor(chunks, [&](int chunk) {
+            body(ChunkBegin(count, chunks, chunk), ChunkBegin(count, chunks, chunk + 1));
+        });
+    }
+
+    static int ChunkBegin(int count, int chunks, int chunk) {
+        return static_cast<int>(static_cast<long long>(count) * chunk / chunks);
+    }
+};
@@ -0,0 +1,580 @@
+#pragma once
+#include <stdexcept>
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include "MemoryUsage.hpp"
+#include "NodePool.hpp"
+
+
+// Doubly linked list whose nodes each hold up to NodeCapacity elements in place.
+// Scans touch one node per NodeCapacity elements, positional walks skip whole nodes,
+// and an insert in the middle shifts at most one node's worth of elements.
+// Nodes are kept at least a quarter full by merging neighbours on removal.
+template <typename T>
+class UnrolledList {
+public:
+    static constexpr int NodeCapacity = std::max<int>(8, 512 / sizeof(T));
+
+private:
+    struct Node {
+        Node* next;
+        Node* prev;
+        int count;
+        alignas(T) unsigned char storage[NodeCapacity * sizeof(T)];
+
+        Node() : next(nullptr), prev(nullptr), count(0) {}
+
+        ~Node() {
+            std::destroy(items(), items() + count);
+        }
+
+        T* items() {
+            return std::launder(reinterpret_cast<T*>(storage));
+        }
+
+        const T* items() const {
+            return std::launder(reinterpret_cast<const T*>(storage));
+        }
+
+        bool full() const {
+            return count == NodeCapacity;
+        }
+
+        // Moves items[index, count) up by one slot; the slot at index is left
+        // uninitialised. The node must not be full.
+        void openSlot(int index) {
+            T* data = items();
+            if (index == count) return;
+
+            ::new (static_cast<void*>(data + count)) T(std::move(data[count - 1]));
+            for (int i = count - 1; i > index; --i) {
+                data[i] = std::move(data[i - 1]);
+            }
+            std::destroy_at(data + index);
+        }
+
+        template <typename... Args>
+        void emplace(int index, Args&&... args) {
+            if (index == count) {
+                ::new (static_cast<void*>(items() + count)) T(std::forward<Args>(args)...);
+            } else {
+                T item(std::forward<Args>(args)...);
+                openSlot(index);
+                ::new (static_cast<void*>(items() + index)) T(std::move(item));
+            }
+            ++count;
+        }
+
+        void erase(int index) {
+            T* data = items();
+            for (int i = index; i + 1 < count; ++i) {
+                data[i] = std::move(data[i + 1]);
+            }
+            std::destroy_at(data + --count);
+        }
+
+        // Moves items[from, count) to the end of other.
+        void moveTail(int from, Node* other) {
+            T* data = items();
+            T* target = other->items() + other->count;
+            for (int i = from; i < count; ++i) {
+                ::new (static_cast<void*>(target++)) T(std::move(data[i]));
+            }
+            std::destroy(data + from, data + count);
+            other->count += count - from;
+            count = from;
+        }
+    };
+
+    using Pool = NodePool<Node>;
+    using Slot = typename Pool::Slot;
+
+    Node* head;
+    Node* tail;
+    int size;
+
+    void _checkException(int index) const {
+        if (index < 0 || index >= size) {
+            throw std::out_of_range("Index out of range");
+        }
+    }
+
+    static Node* _createNode() {
+        Slot* slot = Pool::Shared().Take(1);
+        return ::new (static_cast<void*>(slot->storage)) Node();
+    }
+
+    static void _destroyNode(Node* node) {
+        node->~Node();
+        Slot* slot = reinterpret_cast<Slot*>(node);
+        Pool::Shared().Give(slot, slot);
+    }
+
+    // Links node in front of position (at the end if null).
+    void _linkBefore(Node* position, Node* node) {
+        Node* before = position ? position->prev : tail;
+
+        node->prev = before;
+        node->next = position;
+        if (before) {
+            before->next = node;
+        } else {
+            head = node;
+        }
+        if (position) {
+            position->prev = node;
+        } else {
+            tail = node;
+        }
+    }
+
+    void _unlink(Node* node) {
+        if (node->prev) {
+            node->prev->next = node->next;
+        } else {
+            head = node->next;
+        }
+        if (node->next) {
+            node->next->prev = node->prev;
+        } else {
+            tail = node->prev;
+        }
+    }
+
+    // Finds the node holding index, walking whole nodes from the nearer end, and
+    // turns index into an offset inside it.
+    Node* _locate(int& index) const {
+        if (index * 2 < size) {
+            Node* current = head;
+            while (index >= current->count) {
+                index -= current->count;
+                current = current->next;
+            }
+            return current;
+        }
+
+        int end = size;
+        Node* current = tail;
+        while (index < end - current->count) {
+            end -= current->count;
+            current = current->prev;
+        }
+        index -= end - current->count;
+        return current;
+    }
+
+    void _mergeUnderfull(Node* node) {
+        if (node->count == 0) {
+            _unlink(node);
+            _destroyNode(node);
+            return;
+        }
+        if (node->count * 4 >= NodeCapacity) return;
+
+        if (node->next && node->count + node->next->count <= NodeCapacity) {
+            Node* next = node->next;
+            next->moveTail(0, node);
+            _unlink(next);
+            _destroyNode(next);
+        } else if (node->prev && node->count + node->prev->count <= NodeCapacity) {
+            node->moveTail(0, node->prev);
+            _unlink(node);
+            _destroyNode(node);
+        }
+    }
+
+    template <typename Visitor>
+    bool _forEachWhile(Visitor& visit) const {
+        for (const Node* current = head; current != nullptr; current = current->next) {
+            const T* items = current->items();
+            for (int i = 0; i < current->count; ++i) {
+                if (!visit(items[i])) return false;
+            }
+        }
+        return true;
+    }
+
+public:
+    // Bidirectional cursor over the elements. It is invalidated by any insert or
+    // removal, since elements move between and within nodes.
+    template <bool IsConst, bool IsReverse>
+    class Cursor {
+    private:
+        friend class UnrolledList<T>;
+        friend class Cursor<!IsConst, IsReverse>;
+
+        using List = std::conditional_t<IsConst, const UnrolledList<T>, UnrolledList<T>>;
+
+        Node* node;
+        int offset;
+        List* list;
+
+        Cursor(Node* node_, int offset_, List* list_) : node(node_), offset(offset_), list(list_) {}
+
+        void forward() {
+            if (++offset == node->count) {
+                node = node->next;
+                offset = 0;
+            }
+        }
+
+        void backward() {
+            if (node == nullptr) {
+                node = list->tail;
+                offset = node->count - 1;
+            } else if (offset-- == 0) {
+                node = node->prev;
+                offset = node ? node->count - 1 : 0;
+            }
+        }
+
+    public:
+        using iterator_category = std::bidirectional_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = std::conditional_t<IsConst, const T*, T*>;
+        using reference = std::conditional_t<IsConst, const T&, T&>;
+
+        Cursor() : node(nullptr), offset(0), list(nullptr) {}
+
+        template <bool OtherConst, typename = std::enable_if_t<IsConst && !OtherConst>>
+        Cursor(const Cursor<OtherConst, IsReverse>& other) :
+            node(other.node), offset(other.offset), list(other.list) {}
+
+        reference operator*() const {
+            return node->items()[offset];
+        }
+
+        pointer operator->() const {
+            return node->items() + offset;
+        }
+
+        Cursor& operator++() {
+            if (IsReverse) {
+                backward();
+            } else {
+                forward();
+            }
+            return *this;
+        }
+
+        Cursor operator++(int) {
+            Cursor old = *this;
+            ++*this;
+            return old;
+        }
+
+        Cursor& operator--() {
+            if (IsReverse) {
+                if (node == nullptr) {
+                    node = list->head;
+                    offset = 0;
+                } else {
+                    forward();
+                }
+            } else {
+                backward();
+            }
+            return *this;
+        }
+
+        Cursor operator--(int) {
+            Cursor old = *this;
+            --*this;
+            return old;
+        }
+
+        bool operator==(const Cursor& other) const {
+            return node == other.node && offset == other.offset;
+        }
+
+        bool operator!=(const Cursor& other) const {
+            return !(*this == other);
+        }
+    };
+
+    using Iterator = Cursor<false, false>;
+    using ConstIterator = Cursor<true, false>;
+    using ReverseIterator = Cursor<false, true>;
+    using ConstReverseIterator = Cursor<true, true>;
+
+    UnrolledList() : head(nullptr), tail(nullptr), size(0) {}
+
+    UnrolledList(const T* items, int count) : UnrolledList() {
+        for (int i = 0; i < count; ++i) {
+            Append(items[i]);
+        }
+    }
+
+    UnrolledList(const UnrolledList<T>& other) : UnrolledList() {
+        other.ForEach([this](const T& item) {
+            Append(item);
+        });
+    }
+
+    UnrolledList(UnrolledList<T>&& other) noexcept : head(other.head), tail(other.tail), size(other.size) {
+        other.head = other.tail = nullptr;
+        other.size = 0;
+    }
+
+    ~UnrolledList() {
+        Clear();
+    }
+
+    UnrolledList<T>& operator=(const UnrolledList<T>& other) {
+        if (this != &other) {
+            UnrolledList<T> copy(other);
+            *this = std::move(copy);
+        }
+        return *this;
+    }
+
+    UnrolledList<T>& operator=(UnrolledList<T>&& other) noexcept {
+        if (this != &other) {
+            Clear();
+            head = other.head;
+            tail = other.tail;
+            size = other.size;
+
+            other.head = other.tail = nullptr;
+            other.size = 0;
+        }
+        return *this;
+    }
+
+    void Clear() {
+        while (head != nullptr) {
+            Node* next = head->next;
+            _destroyNode(head);
+            head = next;
+        }
+
+        tail = nullptr;
+        size = 0;
+    }
+
+    int GetSize() const {
+        return size;
+    }
+
+    // Empty slots in partly filled nodes count as slack. Walks the nodes, not the elements,
+    // unless the elements own heap memory.
+    MemoryUsage GetMemoryUsage() const {
+        MemoryUsage usage;
+        usage.payload = sizeof(T) * size;
+        usage.overhead = sizeof(*this);
+        for (const Node* node = head; node != nullptr; node = node->next) {
+            usage.overhead += sizeof(Node) - sizeof(node->storage);
+            usage.slack += sizeof(T) * (NodeCapacity - node->count);
+            if constexpr (OwnedHeap<T>::Tracked) {
+                for (int i = 0; i < node->count; ++i) {
+                    usage.payload += OwnedHeap<T>::Bytes(node->items()[i]);
+                }
+            }
+        }
+        return usage;
+    }
+
+    Iterator begin() {
+        return Iterator(head, 0, this);
+    }
+
+    Iterator end() {
+        return Iterator(nullptr, 0, this);
+    }
+
+    ConstIterator begin() const {
+        return ConstIterator(head, 0, this);
+    }
+
+    ConstIterator end() const {
+        return ConstIterator(nullptr, 0, this);
+    }
+
+    ConstIterator cbegin() const {
+        return begin();
+    }
+
+    ConstIterator cend() const {
+        return end();
+    }
+
+    ReverseIterator rbegin() {
+        return tail ? ReverseIterator(tail, tail->count - 1, this) : rend();
+    }
+
+    ReverseIterator rend() {
+        return ReverseIterator(nullptr, 0, this);
+    }
+
+    ConstReverseIterator rbegin() const {
+        return tail ? ConstReverseIterator(tail, tail->count - 1, this) : rend();
+    }
+
+    ConstReverseIterator rend() const {
+        return ConstReverseIterator(nullptr, 0, this);
+    }
+
+    template <typename... Args>
+    T& EmplaceBack(Args&&... args) {
+        if (tail == nullptr || tail->full()) {
+            Node* node = _createNode();
+            try {
+                node->emplace(0, std::forward<Args>(args)...);
+            } catch (...) {
+                _destroyNode(node);
+                throw;
+            }
+            _linkBefore(nullptr, node);
+        } else {
+            tail->emplace(tail->count, std::forward<Args>(args)...);
+        }
+
+        ++size;
+        return tail->items()[tail->count - 1];
+    }
+
+    void Append(const T& value) {
+        EmplaceBack(value);
+    }
+
+    void Prepend(const T& value) {
+        if (head == nullptr || head->full()) {
+            Node* node = _createNode();
+            try {
+                node->emplace(0, value);
+            } catch (...) {
+                _destroyNode(node);
+                throw;
+            }
+            _linkBefore(head, node);
+        } else {
+            head->emplace(0, value);
+        }
+        ++size;
+    }
+
+    // index may equal GetSize() to append.
+    void InsertAt(const T& item, int index) {
+        if (index < 0 || index > size) {
+            throw std::out_of_range("Index out of range");
+        }
+        if (index == size) {
+            Append(item);
+            return;
+        }
+
+        Node* node = _locate(index);
+        if (node->full()) {
+            Node* half = _createNode();
+            node->moveTail(NodeCapacity / 2, half);
+            _linkBefore(node->next, half);
+
+            if (index > node->count) {
+                index -= node->count;
+                node = half;
+            }
+        }
+
+        node->emplace(index, item);
+        ++size;
+    }
+
+    void RemoveAt(int index) {
+        _checkException(index);
+
+        Node* node = _locate(index);
+        node->erase(index);
+        --size;
+        _mergeUnderfull(node);
+    }
+
+    T& Get(int index) const {
+        _checkException(index);
+
+        Node* node = _locate(index);
+        return node->items()[index];
+    }
+
+    T& GetFirst() const {
+        if (size == 0)
+            throw std::out_of_range("List is empty");
+        return head->items()[0];
+    }
+
+    T& GetLast() const {
+        if (size == 0)
+            throw std::out_of_range("List is empty");
+        return tail->items()[tail->count - 1];
+    }
+
+    template <typename Visitor>
+    void ForEach(Visitor visit) const {
+        auto visitAll = [&](const T& item) {
+            visit(item);
+            return true;
+        };
+        _forEachWhile(visitAll);
+    }
+
+    template <typename Visitor>
+    bool ForEachWhile(Visitor visit) const {
+        return _forEachWhile(visit);
+    }
+
+    // Copies the elements startIndex..endIndex, in reverse order if startIndex > endIndex.
+    UnrolledList<T>* GetSubList(int startIndex, int endIndex) const {
+        _checkException(startIndex);
+        _checkException(endIndex);
+
+        UnrolledList<T>* result = new UnrolledList<T>();
+        try {
+            if (startIndex <= endIndex) {
+                ConstIterator current(nullptr, 0, this);
+                int offset = startIndex;
+                current.node = _locate(offset);
+                current.offset = offset;
+                for (int i = startIndex; i <= endIndex; ++i, ++current) {
+                    result->Append(*current);
+                }
+            } else {
+                ConstReverseIterator current(nullptr, 0, this);
+                int offset = startIndex;
+                current.node = _locate(offset);
+                current.offset = offset;
+                for (int i = startIndex; endIndex <= i; --i, ++current) {
+                    result->Append(*current);
+                }
+            }
+        } catch (...) {
+            delete result;
+            throw;
+        }
+        return result;
+    }
+
+    // O(1) concatenation that steals the nodes of other.
+    void MoveConcat(UnrolledList<T>& other) {
+        if (&other == this) {
+            throw std::invalid_argument("Cannot concatenate a list with itself");
+        }
+        if (other.head == nullptr) return;
+
+        if (tail) {
+            tail->next = other.head;
+            other.head->prev = tail;
+        } else {
+            head = other.head;
+        }
+        tail = other.tail;
+        size += other.size;
+
+        other.head = other.tail = nullptr;
+        other.size = 0;
+    }
+};
@@ -0,0 +1,328 @@
+#pragma once
+#include <stdexcept>
+#include <algorithm>
+#include "Sequence.hpp"
+#include "UnrolledList.hpp"
+
+
+// List sequence backed by UnrolledList: the same interface as ListSequence with
+// several elements per node, so scans and positional walks touch far fewer nodes.
+template <typename T>
+class UnrolledListSequence : public Sequence<T> {
+private:
+    UnrolledList<T>* data;
+
+    virtual Sequence<T>* AppendInternal(const T& item) override {
+        this->data->Append(item);
+        return this;
+    }
+
+    virtual Sequence<T>* PrependInternal(const T& item) override {
+        this->data->Prepend(item);
+        return this;
+    }
+
+    virtual Sequence<T>* InsertAtInternal(const T& item, int index) override {
+        this->data->InsertAt(item, index);
+        return this;
+    }
+
+    virtual Sequence<T>* ConcatInternal(const Sequence<T>* other) override {
+        if (other == this) {
+            UnrolledList<T> copy(*this->data);
+            this->data->MoveConcat(copy);
+            return this;
+        }
+
+        other->ForEach([this](const T& item) {
+            this->data->Append(item);
+        });
+        return this;
+    }
+
+    virtual Sequence<T>* RemoveAtInternal(int index) override {
+        this->data->RemoveAt(index);
+        return this;
+    }
+
+protected:
+    virtual UnrolledListSequence<T>* Instance() = 0;
+    virtual UnrolledListSequence<T>* CreateEmptyUnrolledListSequence() const = 0;
+
+    virtual bool ForEachInternal(const std::function<bool(const T&)>& visit) const override {
+        return this->data->ForEachWhile(visit);
+    }
+
+public:
+    UnrolledListSequence() : data(new UnrolledList<T>()) {}
+    UnrolledListSequence(const T* items, int count) : data(new UnrolledList<T>(items, count)) {}
+    UnrolledListSequence(const Sequence<T>& other) : data(new UnrolledList<T>()) {
+        other.ForEach([this](const T& item) {
+            data->Append(item);
+        });
+    }
+    UnrolledListSequence(UnrolledListSequence<T>&& other) noexcept : data(other.data) {
+        other.data = nullptr;
+    }
+    UnrolledListSequence(const UnrolledListSequence<T>& other) : data(new UnrolledList<T>(*other.data)) {}
+
+    ~UnrolledListSequence() override {
+        delete this->data;
+    }
+
+    UnrolledListSequence<T>& operator=(const UnrolledListSequence<T>& other) {
+        if (this != &other) {
+            *this->data = *other.data;
+        }
+        return *this;
+    }
+
+    virtual int GetLength() const override {
+        return this->data->GetSize();
+    }
+
+    virtual MemoryUsage GetMemoryUsage() const override {
+        MemoryUsage usage = this->data->GetMemoryUsage();
+        usage.overhead += sizeof(*this);
+        return usage;
+    }
+
+    const T& GetFirst() const override {
+        if (this->GetLength() == 0) {
+            throw std::out_of_range("Sequence is empty - cannot get first element");
+        }
+
+        return this->data->GetFirst();
+    }
+
+    const T& GetLast() const override {
+        if (this->GetLength() == 0) {
+            throw std::out_of_range("Sequence is empty - cannot get last element");
+        }
+
+        return this->data->GetLast();
+    }
+
+    const T& Get(int index) const override {
+        if (index < 0 || index >= data->GetSize()) {
+            throw std::out_of_range("Sequence index out of range");
+        }
+
+        return this->data->Get(index);
+    }
+
+    T& GetFirst() override {
+        if (this->GetLength() == 0) {
+            throw std::out_of_range("Sequence is empty - cannot get first element");
+        }
+
+        return this->data->GetFirst();
+    }
+
+    T& GetLast() override {
+        if (this->GetLength() == 0) {
+            throw std::out_of_range("Sequence is empty - cannot get last element");
+        }
+
+        return this->data->GetLast();
+    }
+
+    T& Get(int index) override {
+        if (index < 0 || index >= data->GetSize()) {
+            throw std::out_of_range("Sequence index out of range");
+        }
+
+        return this->data->Get(index);
+    }
+
+    T& operator[] (int index) override {
+        return this->data->Get(index);
+    }
+
+    UnrolledListSequence<T>* GetSubsequence(int startIndex, int endIndex) const override {
+        if (std::min(startIndex, endIndex) < 0 || std::max(startIndex, endIndex) >= data->GetSize()) {
+            throw std::out_of_range("Sequence index out of range");
+        }
+
+        UnrolledListSequence<T>* ret = this->CreateEmptyUnrolledListSequence();
+        try {
+            UnrolledList<T>* sublist = this->data->GetSubList(startIndex, endIndex);
+            delete ret->data;
+            ret->data = sublist;
+        } catch (...) {
+            delete ret;
+            throw;
+        }
+
+        return ret;
+    }
+
+    using Iterator = typename UnrolledList<T>::Iterator;
+    using ConstIterator = typename UnrolledList<T>::ConstIterator;
+    using ReverseIterator = typename UnrolledList<T>::ReverseIterator;
+    using ConstReverseIterator = typename UnrolledList<T>::ConstReverseIterator;
+
+    Iterator begin() {
+        return this->data->begin();
+    }
+
+    Iterator end() {
+        return this->data->end();
+    }
+
+    ConstIterator begin() const {
+        return this->data->cbegin();
+    }
+
+    ConstIterator end() const {
+        return this->data->cend();
+    }
+
+    ConstIterator cbegin() const {
+        return this->data->cbegin();
+    }
+
+    ConstIterator cend() const {
+        return this->data->cend();
+    }
+
+    ReverseIterator rbegin() {
+        return this->data->rbegin();
+    }
+
+    ReverseIterator rend() {
+        return this->data->rend();
+    }
+
+    ConstReverseIterator rbegin() const {
+        return static_cast<const UnrolledList<T>*>(this->data)->rbegin();
+    }
+
+    ConstReverseIterator rend() const {
+        return static_cast<const UnrolledList<T>*>(this->data)->rend();
+    }
+
+    template <typename Visitor>
+    void ForEach(Visitor visit) const {
+        this->data->ForEach(visit);
+    }
+
+    template <typename Visitor>
+    bool ForEachWhile(Visitor visit) const {
+        return this->data->ForEachWhile(visit);
+    }
+
+    template <typename Mapper>
+    UnrolledListSequence<T>* Map(Mapper mapper) const {
+        UnrolledListSequence<T>* result = this->CreateEmptyUnrolledListSequence();
+        int index = 0;
+        this->data->ForEach([&](const T& item) {
+            result->data->Append(Sequence<T>::ApplyMapper(mapper, item, index++));
+        });
+        return result;
+    }
+
+    template <typename Predicate>
+    UnrolledListSequence<T>* Where(Predicate wherer) const {
+        UnrolledListSequence<T>* result = this->CreateEmptyUnrolledListSequence();
+        this->data->ForEach([&](const T& item) {
+            if (wherer(item)) {
+                result->data->Append(item);
+            }
+        });
+        return result;
+    }
+
+    template <typename Reducer>
+    T Reduce(Reducer reducer, const T& startVal) const {
+        T accumulator = startVal;
+        this->data->ForEach([&](const T& item) {
+            accumulator = reducer(accumulator, item);
+        });
+        return accumulator;
+    }
+
+    virtual Sequence<T>* Append(const T& item) override {
+        return this->Instance()->AppendInternal(item);
+    }
+
+    virtual Sequence<T>* Prepend(const T& item) override {
+        return this->Instance()->PrependInternal(item);
+    }
+
+    virtual Sequence<T>* InsertAt(const T& item, int index) override {
+        if (index < 0 || index >= this->data->GetSize()) {
+            throw std::out_of_range("Sequence index out of range");
+        }
+        return this->Instance()->InsertAtInternal(item, index);
+    }
+
+    virtual Sequence<T>* Concat(const Sequence<T>* other) override {
+        return this->Instance()->ConcatInternal(other);
+    }
+
+    virtual Sequence<T>* RemoveAt(int index) override {
+        if (index < 0 || index >= this->data->GetSize()) {
+            throw std::out_of_range("Sequence index out of range");
+        }
+        return this->Instance()->RemoveAtInternal(index);
+    }
+};
+
+
+template <typename T>
+class MutableUnrolledListSequence : public UnrolledListSequence<T> {
+public:
+    using tag = MutableSequenceTag;
+
+    MutableUnrolledListSequence() : UnrolledListSequence<T>() {}
+    MutableUnrolledListSequence(const T* items, int count) : UnrolledListSequence<T>(items, count) {}
+    MutableUnrolledListSequence(const Sequence<T>& other) : UnrolledListSequence<T>(other) {}
+    MutableUnrolledListSequence(const MutableUnrolledListSequence<T>& other) : UnrolledListSequence<T>(other) {}
+    MutableUnrolledListSequence(MutableUnrolledListSequence<T>&& other) noexcept :
+        UnrolledListSequence<T>(std::move(other)) {}
+
+    virtual Sequence<T>* CreateEmptySequence() const override {
+        return new MutableUnrolledListSequence<T>();
+    }
+
+    virtual UnrolledListSequence<T>* CreateEmptyUnrolledListSequence() const override {
+        return new MutableUnrolledListSequence<T>();
+    }
+
+    virtual UnrolledListSequence<T>* Instance() override {
+        return this;
+    }
+};
+
+
+// Immutable variant: every update returns a new version sharing structure with the
+// old one through PersistentSequence, as ImmutableListSequence does, instead of
+// cloning the whole list.
+template <typename T>
+class ImmutableUnrolledListSequence : public PersistentSequence<T> {
+private:
+    PersistentSequence<T>* Clone() const {
+        return new ImmutableUnrolledListSequence<T>(*this);
+    }
+
+public:
+    using tag = ImmutableSequenceTag;
+
+    ImmutableUnrolledListSequence() : PersistentSequence<T>() {}
+    ImmutableUnrolledListSequence(const T* items, int count) : PersistentSequence<T>(items, count) {}
+    ImmutableUnrolledListSequence(const Sequence<T>& other) : PersistentSequence<T>(other) {}
+    ImmutableUnrolledListSequence(const ImmutableUnrolledListSequence<T>& other) : PersistentSequence<T>(other) {}
+
+    virtual Sequence<T>* CreateEmptySequence() const override {
+        return new ImmutableUnrolledListSequence<T>();
+    }
+
+    virtual PersistentSequence<T>* CreateEmptyPersistentSequence() const override {
+        return new ImmutableUnrolledListSequence<T>();
+    }
+
+    virtual PersistentSequence<T>* Instance() override {
+        return Clone();
+    }
+};
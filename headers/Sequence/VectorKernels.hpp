@@ -0,0 +1,297 @@
+#pragma once
+#include <cstdint>
+#include <type_traits>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SEQUENCE_AVX2_KERNELS 1
+#include <immintrin.h>
+#endif
+
+
+enum class CompareOp {
+    Less,
+    LessEqual,
+    Greater,
+    GreaterEqual,
+    Equal,
+    NotEqual
+};
+
+
+// Bulk kernels over contiguous arithmetic arrays. int and double get AVX2 versions that
+// are picked at runtime when the CPU supports them; every other case runs the scalar
+// loops, which compilers still vectorise for the baseline instruction set.
+// The vector sum of doubles adds in a different order than a sequential loop, and
+// Min/Max leave the result unspecified when the input contains NaN.
+template <typename T>
+class VectorKernels {
+private:
+    static_assert(std::is_arithmetic_v<T>, "VectorKernels require an arithmetic element type");
+
+    static bool matches(const T& item, CompareOp op, const T& value) {
+        switch (op) {
+            case CompareOp::Less: return item < value;
+            case CompareOp::LessEqual: return item <= value;
+            case CompareOp::Greater: return item > value;
+            case CompareOp::GreaterEqual: return item >= value;
+            case CompareOp::Equal: return item == value;
+            case CompareOp::NotEqual: return item != value;
+        }
+        return false;
+    }
+
+    static T scalarSum(const T* items, int count, T init = T()) {
+        T result = init;
+        for (int i = 0; i < count; ++i) {
+            result += items[i];
+        }
+        return result;
+    }
+
+    static T scalarMin(const T* items, int count, T init) {
+        T result = init;
+        for (int i = 0; i < count; ++i) {
+            result = items[i] < result ? items[i] : result;
+        }
+        return result;
+    }
+
+    static T scalarMax(const T* items, int count, T init) {
+        T result = init;
+        for (int i = 0; i < count; ++i) {
+            result = result < items[i] ? items[i] : result;
+        }
+        return result;
+    }
+
+    static void scalarAffine(const T* items, int count, T scale, T shift, T* out) {
+        for (int i = 0; i < count; ++i) {
+            out[i] = static_cast<T>(items[i] * scale + shift);
+        }
+    }
+
+    static int scalarCompress(const T* items, int count, CompareOp op, T value, T* out) {
+        int written = 0;
+        for (int i = 0; i < count; ++i) {
+            if (matches(items[i], op, value)) {
+                out[written++] = items[i];
+            }
+        }
+        return written;
+    }
+
+#ifdef SEQUENCE_AVX2_KERNELS
+    static constexpr bool hasVectorPath = std::is_same_v<T, int> || std::is_same_v<T, double>;
+
+    static bool avx2Supported() {
+        static const bool supported = __builtin_cpu_supports("avx2");
+        return supported;
+    }
+
+    // Lane permutations that move the selected 32-bit lanes of a 256-bit register to
+    // the front, indexed by the comparison mask. Doubles use two lanes per element.
+    struct CompressTable {
+        alignas(32) std::uint32_t lanes[256][8];
+
+        constexpr CompressTable(int width) : lanes() {
+            int elements = 8 / width;
+            for (int mask = 0; mask < (1 << elements); ++mask) {
+                int next = 0;
+                for (int e = 0; e < elements; ++e) {
+                    if (mask & (1 << e)) {
+                        for (int w = 0; w < width; ++w) {
+                            lanes[mask][next++] = static_cast<std::uint32_t>(e * width + w);
+                        }
+                    }
+                }
+            }
+        }
+    };
+
+    static const CompressTable& compressTable() {
+        static constexpr CompressTable table(sizeof(T) / 4);
+        return table;
+    }
+
+    __attribute__((target("avx2")))
+    static T avx2Sum(const T* items, int count) {
+        int i = 0;
+        alignas(32) T lanes[32 / sizeof(T)];
+
+        if constexpr (std::is_same_v<T, int>) {
+            __m256i acc = _mm256_setzero_si256();
+            for (; i + 8 <= count; i += 8) {
+                acc = _mm256_add_epi32(acc, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(items + i)));
+            }
+            _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), acc);
+        } else {
+            __m256d acc0 = _mm256_setzero_pd();
+            __m256d acc1 = _mm256_setzero_pd();
+            for (; i + 8 <= count; i += 8) {
+                acc0 = _mm256_add_pd(acc0, _mm256_loadu_pd(items + i));
+                acc1 = _mm256_add_pd(acc1, _mm256_loadu_pd(items + i + 4));
+            }
+            _mm256_store_pd(lanes, _mm256_add_pd(acc0, acc1));
+        }
+
+        T result = scalarSum(lanes, 32 / sizeof(T));
+        return scalarSum(items + i, count - i, result);
+    }
+
+    template <bool IsMax>
+    __attribute__((target("avx2")))
+    static T avx2Extreme(const T* items, int count) {
+        int i = 0;
+        alignas(32) T lanes[32 / sizeof(T)];
+
+        if constexpr (std::is_same_v<T, int>) {
+            __m256i acc = _mm256_set1_epi32(items[0]);
+            for (; i + 8 <= count; i += 8) {
+                __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(items + i));
+                acc = IsMax ? _mm256_max_epi32(acc, v) : _mm256_min_epi32(acc, v);
+            }
+            _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), acc);
+        } else {
+            __m256d acc = _mm256_set1_pd(items[0]);
+            for (; i + 4 <= count; i += 4) {
+                __m256d v = _mm256_loadu_pd(items + i);
+                acc = IsMax ? _mm256_max_pd(acc, v) : _mm256_min_pd(acc, v);
+            }
+            _mm256_store_pd(lanes, acc);
+        }
+
+        int laneCount = 32 / sizeof(T);
+        if (IsMax) {
+            return scalarMax(items + i, count - i, scalarMax(lanes, laneCount, lanes[0]));
+        }
+        return scalarMin(items + i, count - i, scalarMin(lanes, laneCount, lanes[0]));
+    }
+
+    __attribute__((target("avx2")))
+    static void avx2Affine(const T* items, int count, T scale, T shift, T* out) {
+        int i = 0;
+
+        if constexpr (std::is_same_v<T, int>) {
+            __m256i mul = _mm256_set1_epi32(scale);
+            __m256i add = _mm256_set1_epi32(shift);
+            for (; i + 8 <= count; i += 8) {
+                __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(items + i));
+                v = _mm256_add_epi32(_mm256_mullo_epi32(v, mul), add);
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), v);
+            }
+        } else {
+            __m256d mul = _mm256_set1_pd(scale);
+            __m256d add = _mm256_set1_pd(shift);
+            for (; i + 4 <= count; i += 4) {
+                __m256d v = _mm256_add_pd(_mm256_mul_pd(_mm256_loadu_pd(items + i), mul), add);
+                _mm256_storeu_pd(out + i, v);
+            }
+        }
+
+        scalarAffine(items + i, count - i, scale, shift, out + i);
+    }
+
+    // Each step stores a full register at out + written. Because written never exceeds
+    // the input position, out only needs room for count elements.
+    __attribute__((target("avx2")))
+    static int avx2Compress(const T* items, int count, CompareOp op, T value, T* out) {
+        const CompressTable& table = compressTable();
+        int written = 0;
+        int i = 0;
+
+        if constexpr (std::is_same_v<T, int>) {
+            __m256i threshold = _mm256_set1_epi32(value);
+            bool useEqual = op == CompareOp::Equal || op == CompareOp::NotEqual;
+            bool swapped = op == CompareOp::Less || op == CompareOp::GreaterEqual;
+            bool inverted = op == CompareOp::LessEqual || op == CompareOp::GreaterEqual || op == CompareOp::NotEqual;
+
+            for (; i + 8 <= count; i += 8) {
+                __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(items + i));
+                __m256i hit = useEqual ? _mm256_cmpeq_epi32(v, threshold)
+                    : swapped ? _mm256_cmpgt_epi32(threshold, v) : _mm256_cmpgt_epi32(v, threshold);
+
+                int mask = _mm256_movemask_ps(_mm256_castsi256_ps(hit));
+                if (inverted) mask ^= 0xFF;
+
+                __m256i perm = _mm256_load_si256(reinterpret_cast<const __m256i*>(table.lanes[mask]));
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + written), _mm256_permutevar8x32_epi32(v, perm));
+                written += __builtin_popcount(mask);
+            }
+        } else {
+            __m256d threshold = _mm256_set1_pd(value);
+
+            for (; i + 4 <= count; i += 4) {
+                __m256d v = _mm256_loadu_pd(items + i);
+                __m256d hit;
+                switch (op) {
+                    case CompareOp::Less: hit = _mm256_cmp_pd(v, threshold, _CMP_LT_OQ); break;
+                    case CompareOp::LessEqual: hit = _mm256_cmp_pd(v, threshold, _CMP_LE_OQ); break;
+                    case CompareOp::Greater: hit = _mm256_cmp_pd(v, threshold, _CMP_GT_OQ); break;
+                    case CompareOp::GreaterEqual: hit = _mm256_cmp_pd(v, threshold, _CMP_GE_OQ); break;
+                    case CompareOp::Equal: hit = _mm256_cmp_pd(v, threshold, _CMP_EQ_OQ); break;
+                    default: hit = _mm256_cmp_pd(v, threshold, _CMP_NEQ_UQ); break;
+                }
+
+                int mask = _mm256_movemask_pd(hit);
+                __m256i perm = _mm256_load_si256(reinterpret_cast<const __m256i*>(table.lanes[mask]));
+                __m256 packed = _mm256_permutevar8x32_ps(_mm256_castpd_ps(v), perm);
+                _mm256_storeu_pd(out + written, _mm256_castps_pd(packed));
+                written += __builtin_popcount(mask);
+            }
+        }
+
+        return written + scalarCompress(items + i, count - i, op, value, out + written);
+    }
+#endif
+
+public:
+    static T Sum(const T* items, int count) {
+#ifdef SEQUENCE_AVX2_KERNELS
+        if constexpr (hasVectorPath) {
+            if (avx2Supported()) return avx2Sum(items, count);
+        }
+#endif
+        return scalarSum(items, count);
+    }
+
+    // count must be positive.
+    static T Min(const T* items, int count) {
+#ifdef SEQUENCE_AVX2_KERNELS
+        if constexpr (hasVectorPath) {
+            if (avx2Supported()) return avx2Extreme<false>(items, count);
+        }
+#endif
+        return scalarMin(items, count, items[0]);
+    }
+
+    // count must be positive.
+    static T Max(const T* items, int count) {
+#ifdef SEQUENCE_AVX2_KERNELS
+        if constexpr (hasVectorPath) {
+            if (avx2Supported()) return avx2Extreme<true>(items, count);
+        }
+#endif
+        return scalarMax(items, count, items[0]);
+    }
+
+    // out[i] = items[i] * scale + shift
+    static void Affine(const T* items, int count, T scale, T shift, T* out) {
+#ifdef SEQUENCE_AVX2_KERNELS
+        if constexpr (hasVectorPath) {
+            if (avx2Supported()) return avx2Affine(items, count, scale, shift, out);
+        }
+#endif
+        scalarAffine(items, count, scale, shift, out);
+    }
+
+    // Copies the items satisfying `item op value` to out, preserving order, and returns
+    // how many were kept. out must have room for count elements and not alias items.
+    static int Compress(const T* items, int count, CompareOp op, T value, T* out) {
+#ifdef SEQUENCE_AVX2_KERNELS
+        if constexpr (hasVectorPath) {
+            if (avx2Supported()) return avx2Compress(items, count, op, value, out);
+        }
+#endif
+        return scalarCompress(items, count, op, value, out);
+    }
+};
@@ -5,88 +5,131 @@
 template<typename T>
 class Set {
 private:
-    AVLTree<T>* tree;
+    AVLTree<T> tree;
 
 public:
-    Set() : tree(new AVLTree<T>()) {}
+    Set() : tree() {}
 
     template<typename Sequence>
-    Set(const Sequence& sequence) : tree(new AVLTree<T>()) {
+    Set(const Sequence& sequence) : tree() {
         for (const auto& item : sequence) {
             this->insert(item);
         }
     }
 
-    ~Set() {
-        delete tree;
+    Set(const Set<T>& other) : tree(other.tree) {}
+
+    Set(Set<T>&& other) noexcept : tree(std::move(other.tree)) {}
+
+    Set<T>& operator=(const Set<T>& other) {
+        this->tree = other.tree;
+        return *this;
+    }
+
+    Set<T>& operator=(Set<T>&& other) noexcept {
+        this->tree = std::move(other.tree);
+        return *this;
+    }
+
+    void swap(Set<T>& other) noexcept {
+        this->tree.swap(other.tree);
+    }
+
+    friend void swap(Set<T>& lhs, Set<T>& rhs) noexcept {
+        lhs.swap(rhs);
     }
 
     void insert(const T& value) {
-        if (!this->tree->contains(value))
-            this->tree->insert(value);
+        if (!this->tree.contains(value))
+            this->tree.insert(value);
     }
 
     void remove(const T& value) {
-        this->tree->remove(value);
+        this->tree.remove(value);
+    }
+
+    void insertBulk(const T* items, int count) {
+        this->tree.insertBulk(items, count);
+    }
+
+    // Bulk-loads every element of a container or SequenceView exposing ForEach.
+    template<typename Source>
+    void insertAll(const Source& source) {
+        DynamicArray<T> items;
+        source.ForEach([&](const T& item) {
+            items.EmplaceBack(item);
+        });
+        insertBulk(items.GetData(), items.GetSize());
     }
 
     bool contains(const T& value) const {
-        return this->tree->contains(value);
+        return this->tree.contains(value);
     }
 
     bool empty() const {
-        return this->tree->empty();
+        return this->tree.empty();
     }
 
     void clear() {
-        this->tree->clear();
+        this->tree.clear();
     }
 
     int size() const {
-        return this->tree->size();
+        return this->tree.size();
     }
 
-    Set<T>* unionWith(const Set<T>* other) const {
-        Set<T>* result = new Set<T>();
-        auto elements = this->tree->traverse();
-
-        for (const auto& pair : elements) {
-            result->insert(pair.first);
-        }
-
-        auto otherElements = other->tree->traverse();
-        for (const auto& pair : otherElements) {
-            result->insert(pair.first);
-        }
+    MemoryUsage memoryUsage() const {
+        MemoryUsage usage = this->tree.memoryUsage();
+        usage.overhead += sizeof(*this) - sizeof(this->tree);
+        return usage;
+    }
 
+    Set<T>* unionWith(const Set<T>* other) const {
+        Set<T>* result = new Set<T>(*this);
+        *result |= *other;
+        return result;
+    }
 
+    Set<T>* intersectionWith(const Set<T>* other) const {
+        Set<T>* result = new Set<T>(*this);
+        *result &= *other;
         return result;
     }
 
-    Set<T>* intersectionWith(const Set<T>* other) {
-        Set<T>* result = new Set<T>();
-        auto elements = this->tree->traverse();
-        for (const auto& pair : elements) {
-            if (other->contains(pair.first)) {
-                result->insert(pair.first);
-            }
-        }
+    Set<T>* differenceWith(const Set<T>* other) const {
+        Set<T>* result = new Set<T>(*this);
+        *result -= *other;
         return result;
     }
 
-    Set<T>* differenceWith(const Set<T>* other) {
-        Set<T>* result = new Set<T>();
-        auto elements = this->tree->traverse();
-        for (const auto& pair : elements) {
-            if (!other->contains(pair.first)) {
-                result->insert(pair.first);
-            }
-        }
+    Set<T>* symmetricDifferenceWith(const Set<T>* other) const {
+        Set<T>* result = new Set<T>(*this);
+        *result ^= *other;
         return result;
     }
 
+    Set<T>& operator|=(const Set<T>& other) {
+        this->tree.unite(other.tree);
+        return *this;
+    }
+
+    Set<T>& operator&=(const Set<T>& other) {
+        this->tree.intersect(other.tree);
+        return *this;
+    }
+
+    Set<T>& operator-=(const Set<T>& other) {
+        this->tree.subtract(other.tree);
+        return *this;
+    }
+
+    Set<T>& operator^=(const Set<T>& other) {
+        this->tree.symmetricSubtract(other.tree);
+        return *this;
+    }
+
     void print() const {
-        auto elements = tree->traverse();
+        auto elements = tree.traverse();
         std::cout << "{ ";
         for (const auto& pair : elements) {
             std::cout << pair.first << " ";
@@ -95,7 +138,7 @@ public:
     }
 
     bool isSubsetOf(const Set<T>* other) const {
-        auto elements = tree->traverse();
+        auto elements = tree.traverse();
         for (const auto& pair : elements) {
             if (!other->contains(pair.first)) {
                 return false;
@@ -124,6 +167,26 @@ public:
         return this->symmetricDifferenceWith(other);
     }
     
+    friend Set<T> operator+(Set<T> lhs, const Set<T>& rhs) {
+        lhs |= rhs;
+        return lhs;
+    }
+
+    friend Set<T> operator*(Set<T> lhs, const Set<T>& rhs) {
+        lhs &= rhs;
+        return lhs;
+    }
+
+    friend Set<T> operator-(Set<T> lhs, const Set<T>& rhs) {
+        lhs -= rhs;
+        return lhs;
+    }
+
+    friend Set<T> operator^(Set<T> lhs, const Set<T>& rhs) {
+        lhs ^= rhs;
+        return lhs;
+    }
+
     bool operator<=(const Set<T>* other) const {
         return this->isSubsetOf(other);
     }
@@ -132,21 +195,21 @@ public:
         return this->equals(other);
     }
 
-    Set<T>* map(const std::function<T(const T&)>& func) const {
-        Set<T> result = new Set<T>();
-        auto elements = tree->traverse();
+    Set<T> map(const std::function<T(const T&)>& func) const {
+        Set<T> result;
+        auto elements = tree.traverse();
         for (const auto& pair : elements) {
-            result->insert(func(pair.first));
+            result.insert(func(pair.first));
         }
         return result;
     }
     
     Set<T> where(const std::function<bool(const T&)>& predicate) const {
-        Set<T> result = new Set<T>();
-        auto elements = tree->traverse();
+        Set<T> result;
+        auto elements = tree.traverse();
         for (const auto& pair : elements) {
             if (predicate(pair.first)) {
-                result->insert(pair.first);
+                result.insert(pair.first);
             }
         }
         return result;
@@ -154,15 +217,19 @@ public:
     
     T reduce(const std::function<T(const T&, const T&)>& func, const T& initial) const {
         T result = initial;
-        auto elements = tree->traverse();
+        auto elements = tree.traverse();
         for (const auto& pair : elements) {
             result = func(result, pair.first);
         }
         return result;
     }
     
-    AVLTree<T>* getTree() const {
-        return tree;
+    AVLTree<T>* getTree() {
+        return &tree;
+    }
+
+    const AVLTree<T>* getTree() const {
+        return &tree;
     }
 };
 
@@ -0,0 +1,182 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include <iostream>
+#include "Sequence/MemoryUsage.hpp"
+
+
+// Process-wide pool of immutable strings. Each distinct text is stored once, in blocks
+// of records that never move, so a handle to it is a single pointer and equal texts
+// always get the same handle. The pool is split into independently locked shards so
+// threads interning different strings rarely contend. Interned strings live until
+// the program exits.
+class StringPool {
+public:
+    struct Record {
+        std::string text;
+    };
+
+private:
+    static constexpr int ShardCount = 16;
+    static constexpr int RecordsPerBlock = 1024;
+
+    struct Shard {
+        std::mutex mutex;
+        std::unordered_map<std::string_view, const Record*> index;
+        std::vector<std::unique_ptr<Record[]>> blocks;
+        int usedInBlock = RecordsPerBlock;
+    };
+
+    Shard shards[ShardCount];
+
+    StringPool() = default;
+
+public:
+    StringPool(const StringPool&) = delete;
+    StringPool& operator=(const StringPool&) = delete;
+
+    static StringPool& Shared() {
+        static StringPool* pool = new StringPool();
+        return *pool;
+    }
+
+    static const Record* Empty() {
+        static const Record empty;
+        return &empty;
+    }
+
+    const Record* Intern(std::string_view text) {
+        if (text.empty()) return Empty();
+
+        std::size_t hash = std::hash<std::string_view>()(text);
+        Shard& shard = shards[hash % ShardCount];
+        std::lock_guard<std::mutex> lock(shard.mutex);
+
+        auto found = shard.index.find(text);
+        if (found != shard.index.end()) return found->second;
+
+        if (shard.usedInBlock == RecordsPerBlock) {
+            shard.blocks.push_back(std::make_unique<Record[]>(RecordsPerBlock));
+            shard.usedInBlock = 0;
+        }
+
+        Record* record = &shard.blocks.back()[shard.usedInBlock++];
+        record->text.assign(text.data(), text.size());
+        shard.index.emplace(std::string_view(record->text), record);
+        return record;
+    }
+
+    // Record for text if it has already been interned, or null. Never adds to the pool,
+    // so lookups with arbitrary keys cannot grow it.
+    const Record* Find(std::string_view text) {
+        if (text.empty()) return Empty();
+
+        std::size_t hash = std::hash<std::string_view>()(text);
+        Shard& shard = shards[hash % ShardCount];
+        std::lock_guard<std::mutex> lock(shard.mutex);
+
+        auto found = shard.index.find(text);
+        return found != shard.index.end() ? found->second : nullptr;
+    }
+
+    // Number of distinct non-empty strings interned so far.
+    std::size_t GetSize() {
+        std::size_t size = 0;
+        for (Shard& shard : shards) {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            size += shard.index.size();
+        }
+        return size;
+    }
+
+    // Memory behind every InternedString: the texts are payload, the lookup index is
+    // overhead (estimated from its bucket and node counts) and unused records are slack.
+    MemoryUsage GetMemoryUsage() {
+        using IndexNode = std::pair<const std::string_view, const Record*>;
+
+        MemoryUsage usage;
+        usage.overhead = sizeof(*this);
+        for (Shard& shard : shards) {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+
+            std::size_t used = shard.index.size();
+            std::size_t allocated = shard.blocks.size() * RecordsPerBlock;
+            usage.payload += sizeof(Record) * used;
+            usage.slack += sizeof(Record) * (allocated - used);
+            usage.overhead += shard.index.bucket_count() * sizeof(void*)
+                + used * (sizeof(IndexNode) + 2 * sizeof(void*))
+                + shard.blocks.capacity() * sizeof(shard.blocks[0]);
+            for (const auto& entry : shard.index) {
+                usage.payload += OwnedHeap<std::string>::Bytes(entry.second->text);
+            }
+        }
+        return usage;
+    }
+};
+
+
+// Pointer-sized handle to a string in StringPool::Shared(). Copying and equality are
+// O(1); ordering compares the texts.
+class InternedString {
+private:
+    const StringPool::Record* record;
+
+public:
+    InternedString() : record(StringPool::Empty()) {}
+    InternedString(std::string_view text) : record(StringPool::Shared().Intern(text)) {}
+    InternedString(const std::string& text) : InternedString(std::string_view(text)) {}
+    InternedString(const char* text) : InternedString(std::string_view(text)) {}
+
+    // Points result at text and returns true if text is already pooled; otherwise returns
+    // false without interning it. No stored InternedString can equal a text that is absent.
+    static bool Find(std::string_view text, InternedString& result) {
+        const StringPool::Record* found = StringPool::Shared().Find(text);
+        if (found == nullptr) return false;
+
+        result.record = found;
+        return true;
+    }
+
+    const std::string& Get() const { return record->text; }
+    std::string_view View() const { return record->text; }
+    bool Empty() const { return record->text.empty(); }
+
+    bool operator==(const InternedString& other) const {
+        return record == other.record;
+    }
+
+    bool operator!=(const InternedString& other) const {
+        return record != other.record;
+    }
+
+    bool operator<(const InternedString& other) const {
+        return record != other.record && record->text < other.record->text;
+    }
+
+    int Compare(const InternedString& other) const {
+        return record == other.record ? 0 : record->text.compare(other.record->text);
+    }
+
+    std::size_t Hash() const {
+        return std::hash<const void*>()(record);
+    }
+
+    friend std::ostream& operator<<(std::ostream& os, const InternedString& str) {
+        os << str.record->text;
+        return os;
+    }
+};
+
+namespace std {
+    template <>
+    struct hash<InternedString> {
+        size_t operator()(const InternedString& str) const {
+            return str.Hash();
+        }
+    };
+}
@@ -0,0 +1,9 @@
+#include "HeadlessTester.hpp"
+
+
+// Differential tests of the trees, sets and sequences against the standard containers;
+// see HeadlessTester.hpp for the options, e.g.
+//     headless_tests --types=int --sequences=segmented,rope --ops=100000
+int main(int argc, char** argv) {
+    return HeadlessTester::run(argc, argv);
+}